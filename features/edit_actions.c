@@ -0,0 +1,56 @@
+#include "edit_actions.h"
+#include "zilpzalp.h"
+
+#define EDIT_ACTION_COUNT (EDIT_SELECT_WORD - EDIT_DELETE_WORD + 1)
+#define EDIT_ACTION_LENGTH 6 // keycodes per action, KC_NO terminated unless all are used
+
+// The shortcuts, tapped one after the other:
+static const uint16_t PROGMEM shortcuts[EDIT_HOST_COUNT][EDIT_ACTION_COUNT][EDIT_ACTION_LENGTH] = {
+    [EDIT_HOST_MAC] = {
+        {A(KC_BSPC)},
+        {G(KC_LEFT), S(G(KC_RIGHT)), KC_BSPC},
+        {G(KC_LEFT), S(G(KC_RIGHT)), G(KC_C), G(KC_RIGHT), KC_ENTER, G(KC_V)},
+        {A(KC_RIGHT), S(A(KC_LEFT))},
+    },
+    [EDIT_HOST_LINUX] = {
+        {C(KC_BSPC)},
+        {KC_HOME, S(KC_END), KC_BSPC},
+        {KC_HOME, S(KC_END), C(KC_C), KC_END, KC_ENTER, C(KC_V)},
+        {C(KC_RIGHT), S(C(KC_LEFT))},
+    },
+    [EDIT_HOST_WINDOWS] = {
+        {C(KC_BSPC)},
+        {KC_HOME, S(KC_END), KC_BSPC},
+        {KC_HOME, S(KC_END), C(KC_C), KC_END, KC_ENTER, C(KC_V)},
+        {C(KC_RIGHT), S(C(KC_LEFT))},
+    },
+};
+
+static edit_host_t host = EDIT_ACTIONS_HOST;
+
+void edit_actions_set_host(edit_host_t new_host) {
+    if (new_host < EDIT_HOST_COUNT) {
+        host = new_host;
+    }
+}
+
+edit_host_t edit_actions_get_host(void) {
+    return host;
+}
+
+bool edit_actions_process(uint16_t keycode, keyrecord_t *record) {
+    if (keycode < EDIT_DELETE_WORD || keycode > EDIT_SELECT_WORD) {
+        return true;
+    }
+    if (record->event.pressed) {
+        const uint16_t *shortcut = shortcuts[host][keycode - EDIT_DELETE_WORD];
+        for (uint8_t i = 0; i < EDIT_ACTION_LENGTH; i++) {
+            uint16_t code = pgm_read_word(&shortcut[i]);
+            if (code == KC_NO) {
+                break;
+            }
+            macro_queue_tap(code);
+        }
+    }
+    return false;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Editing actions.
+ *
+ *  The keycodes EDIT_DELETE_WORD, EDIT_DELETE_LINE, EDIT_DUPLICATE_LINE and EDIT_SELECT_WORD (see
+ *  zilpzalp.h) type the shortcuts that do the same on the selected host, e.g. Alt+Backspace on a
+ *  Mac and Ctrl+Backspace elsewhere. The shortcuts are sent through the macro queue (enabled along
+ *  with this feature), so the keymap goes on scanning while they play.
+ *
+ *  The host is EDIT_ACTIONS_HOST unless changed at runtime by `edit_actions_set_host()`. Delete
+ *  line selects from the start to the end of the line and deletes it; duplicate line copies the
+ *  line through the clipboard, whose previous content is lost. Select word moves to the end of
+ *  the word and selects back to its start.
+ *
+ *  An action is played once per press and does not repeat while the key is held. Where the host
+ *  shortcut is a single key that should auto-repeat, e.g. Ctrl+Backspace, bind it directly.
+ */
+
+typedef enum {
+    EDIT_HOST_MAC,
+    EDIT_HOST_LINUX,
+    EDIT_HOST_WINDOWS,
+    EDIT_HOST_COUNT,
+} edit_host_t;
+
+#ifndef EDIT_ACTIONS_HOST
+#    define EDIT_ACTIONS_HOST EDIT_HOST_MAC
+#endif
+
+void        edit_actions_set_host(edit_host_t host);
+edit_host_t edit_actions_get_host(void);
+
+// Called from `process_record_kb`. Returns false for the editing keycodes.
+bool edit_actions_process(uint16_t keycode, keyrecord_t *record);
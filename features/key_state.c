@@ -0,0 +1,37 @@
+#include "key_state.h"
+
+static key_state_t keys[MATRIX_ROWS][MATRIX_COLS];
+
+key_state_t *key_state(keypos_t key) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return NULL;
+    }
+    return &keys[key.row][key.col];
+}
+
+void key_state_rewrite(keyrecord_t *record, uint16_t keycode) {
+    key_state_t *key = key_state(record->event.key);
+    if (key && record->event.pressed) {
+        key->rewrite    = keycode;
+        record->keycode = keycode;
+    }
+}
+
+void key_state_enter(uint16_t keycode, keyrecord_t *record) {
+    key_state_t *key = key_state(record->event.key);
+    if (!key) {
+        return;
+    }
+    if (!record->event.pressed) {
+        key->down = false;
+        if (key->rewrite) {
+            record->keycode = key->rewrite;
+            key->rewrite    = 0;
+        }
+        return;
+    }
+    key->time    = record->event.time;
+    key->keycode = keycode;
+    key->down    = true;
+    key->rewrite = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Per-key state shared by the keyboard-level features.
+ *
+ *  Every key event passes `pre_process_record_kb` before combos and tap-hold see it. The state of
+ *  every key is kept there (press time, keycode, rewrite), which the features read instead of
+ *  keeping their own tables. It never changes a keycode by itself; only the features do, through
+ *  `key_state_rewrite`.
+ */
+
+#if !defined(COMBO_ENABLE) && !defined(REPEAT_KEY_ENABLE)
+#    error "key_state requires COMBO_ENABLE (keyrecord_t.keycode)"
+#endif
+
+typedef struct {
+    uint16_t time;    // event time of the last press
+    uint16_t keycode; // keycode of the last press as looked up in the keymap
+    uint16_t rewrite; // keycode given to the press (and then to its release), 0 if none
+    bool     down;
+} key_state_t;
+
+// Called for every key event before combos and tap-hold see it (first in `pre_process_record_kb`).
+void key_state_enter(uint16_t keycode, keyrecord_t *record);
+
+// State of the key of a matrix event, NULL for other events (e.g. combos).
+key_state_t *key_state(keypos_t key);
+
+// Gives a key press another keycode before combos and tap-hold see it. The key's release is
+// rewritten to the same keycode.
+void key_state_rewrite(keyrecord_t *record, uint16_t keycode);
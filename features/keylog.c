@@ -0,0 +1,104 @@
+#include "keylog.h"
+#include "print.h"
+#include "zilpzalp.h"
+#ifdef PROTOCOL_CHIBIOS
+#    include <ch.h>
+#endif
+
+static keylog_entry_t keylog[KEYLOG_SIZE];
+static uint16_t       keylog_head;      // index of the oldest entry
+static uint16_t       keylog_count;     // number of entries in the buffer
+static uint32_t       keylog_head_time; // µs of the oldest entry
+static uint32_t       keylog_last_time; // µs of the newest entry
+static uint16_t       keylog_dropped;   // entries overwritten since the last dump
+static bool           dumping;
+
+static uint32_t keylog_time_us(void) {
+#ifdef PROTOCOL_CHIBIOS
+    return TIME_I2US(chVTGetSystemTimeX());
+#else
+    return timer_read32() * 1000;
+#endif
+}
+
+static uint32_t keylog_advance(const keylog_entry_t *entry) {
+    return entry->key == KEYLOG_GAP ? (uint32_t)entry->delta << 16 : entry->delta;
+}
+
+// Removes the oldest entry.
+static void keylog_pop(void) {
+    keylog_head = (keylog_head + 1) % KEYLOG_SIZE;
+    keylog_count--;
+    if (keylog_count) {
+        keylog_head_time += keylog_advance(&keylog[keylog_head]);
+    }
+}
+
+static void keylog_push(uint16_t delta, uint8_t key, uint8_t layers) {
+    if (keylog_count == KEYLOG_SIZE) {
+        keylog_pop(); // overwrite the oldest entry
+        if (keylog_dropped < UINT16_MAX) {
+            keylog_dropped++;
+        }
+    }
+    keylog[(keylog_head + keylog_count) % KEYLOG_SIZE] = (keylog_entry_t){.delta = delta, .key = key, .layers = layers};
+    keylog_count++;
+}
+
+void keylog_record(keyrecord_t *record) {
+    keypos_t key = record->event.key;
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return; // not a matrix event (e.g. a combo)
+    }
+    uint32_t now     = keylog_time_us();
+    uint32_t elapsed = now - keylog_last_time;
+    uint8_t  layers  = layer_state | default_layer_state;
+    keylog_last_time = now;
+    if (!keylog_count) {
+        keylog_head_time = now;
+        elapsed          = 0;
+    } else if (elapsed > UINT16_MAX) {
+        keylog_push(elapsed >> 16, KEYLOG_GAP, layers);
+    }
+    keylog_push(elapsed, (key.row << 4 | key.col) | (record->event.pressed ? KEYLOG_PRESSED : 0), layers);
+}
+
+bool keylog_process(uint16_t keycode, keyrecord_t *record) {
+    if (keycode != KEYLOG_DUMP) {
+        return true;
+    }
+    if (record->event.pressed && !dumping && keylog_count) {
+        uprintf("keylog begin %08lX %u\n", (unsigned long)keylog_head_time, keylog_dropped);
+        keylog_dropped = 0;
+        dumping        = true;
+    }
+    return false;
+}
+
+void keylog_task(void) {
+    static const char hex[] = "0123456789ABCDEF";
+    if (!dumping) {
+        return;
+    }
+    // One line per pass: "keylog" and up to KEYLOG_DUMP_BATCH entries as DDDDKKLL (delta, key,
+    // layers). Entries recorded meanwhile are printed as well.
+    char  line[7 + KEYLOG_DUMP_BATCH * 9 + 2] = "keylog";
+    char *end                                 = line + 6;
+    for (uint8_t i = 0; i < KEYLOG_DUMP_BATCH && keylog_count; i++) {
+        const keylog_entry_t *entry = &keylog[keylog_head];
+        uint32_t              value = (uint32_t)entry->delta << 16 | entry->key << 8 | entry->layers;
+        *end++                      = ' ';
+        for (int8_t shift = 28; shift >= 0; shift -= 4) {
+            *end++ = hex[(value >> shift) & 0x0F];
+        }
+        keylog_pop();
+    }
+    *end++ = '\n';
+    *end   = '\0';
+    print(line);
+    if (!keylog_count) {
+        print("keylog end\n");
+        keylog_head = 0;
+        dumping     = false;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Key log for real typing.
+ *
+ *  Records every matrix event (position, press/release, µs timestamp, active layers) in a
+ *  preallocated RAM ring buffer of 4 bytes per entry, so that several thousand events of
+ *  ordinary typing fit. Recording takes a few stores per event; when the buffer is full, the
+ *  oldest entries are overwritten. Pressing `KEYLOG_DUMP` prints the buffer over the console
+ *  (capture it with `qmk console`) and empties it, while recording goes on. `tools/keylog` turns
+ *  the capture into a binary trace and the trace into scripts for the other host tools (see
+ *  tools/readme.md).
+ *
+ *  Unlike `TRACE_ENABLE`, only the key events are recorded, not the decisions made about them.
+ */
+
+#ifndef CONSOLE_ENABLE
+#    error "KEYLOG_ENABLE requires CONSOLE_ENABLE"
+#endif
+
+#ifndef KEYLOG_SIZE
+#    define KEYLOG_SIZE 4096 // number of entries (4 bytes each)
+#endif
+
+#ifndef KEYLOG_DUMP_BATCH
+#    define KEYLOG_DUMP_BATCH 8 // entries printed per housekeeping pass (one console line)
+#endif
+
+#define KEYLOG_PRESSED 0x80 // in `key`: the event is a press
+#define KEYLOG_GAP 0x7F     // `key` of an entry that only extends the time to the next one
+
+typedef struct {
+    uint16_t delta;  // µs since the previous entry; for a gap entry: in units of 65536 µs
+    uint8_t  key;    // matrix position as row << 4 | col, with KEYLOG_PRESSED, or KEYLOG_GAP
+    uint8_t  layers; // layers 0-7 that were on (including the default layer) before the event
+} keylog_entry_t;
+
+// Called for every key event before combos and tap-hold see it.
+void keylog_record(keyrecord_t *record);
+
+// Returns false for `KEYLOG_DUMP` (from `process_record_kb`).
+bool keylog_process(uint16_t keycode, keyrecord_t *record);
+
+// Prints the next entries while a dump is in progress (from `housekeeping_task_kb`).
+void keylog_task(void);
@@ -0,0 +1,264 @@
+#include "latency_probe.h"
+#include "host.h"
+#include "print.h"
+#include "usb_descriptor.h"
+#include "usb_main.h"
+#include "zilpzalp.h"
+#include <ch.h>
+#include <hal.h>
+
+#ifndef PROTOCOL_CHIBIOS
+#    error "LATENCY_PROBE_ENABLE requires ChibiOS"
+#endif
+
+#ifdef KEYBOARD_SHARED_EP
+#    define KEYBOARD_ENDPOINT SHARED_IN_EPNUM
+#else
+#    define KEYBOARD_ENDPOINT KEYBOARD_IN_EPNUM
+#endif
+
+extern matrix_row_t raw_matrix[MATRIX_ROWS]; // the matrix before debouncing, quantum/matrix.c
+
+typedef enum {
+    SAMPLE_PENDING,   // processed, no report yet
+    SAMPLE_QUEUED,    // its report is waiting for the host
+    SAMPLE_ACKED,     // the host has the report
+    SAMPLE_NO_REPORT, // the pass that processed it sent nothing
+} sample_state_t;
+
+typedef struct {
+    uint32_t edge;     // µs, the contact change
+    uint32_t queued;   // µs, the report was handed to the USB stack
+    uint32_t acked;    // µs, the IN transfer of the report completed
+    uint8_t  key;      // row << 4 | col or LATENCY_PROBE_COMBO, with LATENCY_PROBE_PRESSED
+    uint8_t  endpoint; // of the report
+    uint8_t  state;    // sample_state_t
+} sample_t;
+
+static sample_t       samples[LATENCY_PROBE_SIZE];
+static uint8_t        head;       // index of the oldest sample
+static uint8_t        count;      // number of samples in the buffer
+static uint8_t        unreported; // the newest samples that are SAMPLE_PENDING
+static uint16_t       dropped;    // samples lost because the buffer was full
+static bool           active;     // measuring
+static bool           ending;     // printing the rest before the end line
+static matrix_row_t   previous_raw[MATRIX_ROWS], previous_matrix[MATRIX_ROWS];
+static uint32_t       edge_time[MATRIX_ROWS][MATRIX_COLS][2]; // [released, pressed]
+static uint32_t       last_press_edge; // for combos
+static host_driver_t  probe_driver;
+static host_driver_t *original_driver;
+
+static uint32_t probe_time_us(void) {
+    return TIME_I2US(chVTGetSystemTimeX());
+}
+
+static sample_t *sample_at(uint8_t index) {
+    return &samples[(head + index) % LATENCY_PROBE_SIZE];
+}
+
+static bool endpoint_busy(uint8_t endpoint) {
+    osalSysLock();
+    bool busy = usbGetTransmitStatusI(&USB_DRIVER, endpoint);
+    osalSysUnlock();
+    return busy;
+}
+
+static bool usb_active(void) {
+    osalSysLock();
+    bool active = usbGetDriverStateI(&USB_DRIVER) == USB_ACTIVE;
+    osalSysUnlock();
+    return active;
+}
+
+// Pairs the pending samples with the report that was just handed to the USB stack.
+static void report_sent(uint8_t endpoint) {
+    uint32_t now      = probe_time_us();
+    bool     attached = usb_active();
+    for (uint8_t i = 0; i < count - unreported; i++) {
+        sample_t *sample = sample_at(i);
+        if (sample->state == SAMPLE_QUEUED && sample->endpoint == endpoint) {
+            // The driver waits for the previous transfer on the endpoint before it starts a new one.
+            sample->acked = now;
+            sample->state = SAMPLE_ACKED;
+        }
+    }
+    for (uint8_t i = count - unreported; i < count; i++) {
+        sample_t *sample = sample_at(i);
+        sample->queued   = now;
+        sample->endpoint = endpoint;
+        sample->state    = attached ? SAMPLE_QUEUED : SAMPLE_NO_REPORT;
+    }
+    unreported = 0;
+}
+
+static void probe_send_keyboard(report_keyboard_t *report) {
+    original_driver->send_keyboard(report);
+    report_sent(KEYBOARD_ENDPOINT);
+}
+
+#ifdef NKRO_ENABLE
+static void probe_send_nkro(report_nkro_t *report) {
+    original_driver->send_nkro(report);
+    report_sent(SHARED_IN_EPNUM);
+}
+#endif
+
+#ifdef EXTRAKEY_ENABLE
+static void probe_send_extra(report_extra_t *report) {
+    original_driver->send_extra(report);
+    report_sent(SHARED_IN_EPNUM);
+}
+#endif
+
+static void probe_start(void) {
+    original_driver = host_get_driver();
+    probe_driver    = *original_driver;
+    probe_driver.send_keyboard = probe_send_keyboard;
+#ifdef NKRO_ENABLE
+    probe_driver.send_nkro = probe_send_nkro;
+#endif
+#ifdef EXTRAKEY_ENABLE
+    probe_driver.send_extra = probe_send_extra;
+#endif
+    host_set_driver(&probe_driver);
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        previous_raw[row]    = raw_matrix[row];
+        previous_matrix[row] = matrix_get_row(row);
+    }
+    uprintf("latency begin %s", QMK_KEYMAP);
+#ifdef DEBOUNCE
+    uprintf(" debounce=%u", DEBOUNCE);
+#endif
+    uprintf(" tapping_term=%u", TAPPING_TERM);
+#ifdef COMBO_ENABLE
+    uprintf(" combo_term=%u", COMBO_TERM);
+#endif
+#ifdef PERMISSIVE_HOLD
+    print(" permissive_hold");
+#endif
+#ifdef HOLD_ON_OTHER_KEY_PRESS
+    print(" hold_on_other_key_press");
+#endif
+#ifdef NKRO_ENABLE
+    print(" nkro");
+#endif
+#ifdef KEY_STATE_ENABLE
+    print(" key_state");
+#endif
+#ifdef RELEASE_HOLD_ENABLE
+    print(" release_hold");
+#endif
+#ifdef SPECULATIVE_HOLD_ENABLE
+    print(" speculative_hold");
+#endif
+#ifdef LAYER_TAP_STREAK_ENABLE
+    print(" layer_tap_streak");
+#endif
+#ifdef TRACE_ENABLE
+    print(" trace");
+#endif
+#ifdef KEYLOG_ENABLE
+    print(" keylog");
+#endif
+    print("\n");
+    dropped = 0;
+    active  = true;
+}
+
+void latency_probe_scan(void) {
+    uint32_t now = probe_time_us();
+    if (active) {
+        // The first change of the raw matrix away from the debounced state is the contact. A key
+        // that bounces back before it is debounced starts over.
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            matrix_row_t changed = (raw_matrix[row] ^ previous_raw[row]) & ~(previous_raw[row] ^ previous_matrix[row]);
+            for (uint8_t col = 0; changed; col++, changed >>= 1) {
+                if (changed & 1) {
+                    bool pressed                 = raw_matrix[row] & (1 << col);
+                    edge_time[row][col][pressed] = now;
+                    if (pressed) {
+                        last_press_edge = now;
+                    }
+                }
+            }
+            previous_raw[row]    = raw_matrix[row];
+            previous_matrix[row] = matrix_get_row(row);
+        }
+    }
+    for (uint8_t i = 0; i < count - unreported; i++) {
+        sample_t *sample = sample_at(i);
+        if (sample->state == SAMPLE_QUEUED && !endpoint_busy(sample->endpoint)) {
+            sample->acked = now;
+            sample->state = SAMPLE_ACKED;
+        }
+    }
+}
+
+bool latency_probe_process(uint16_t keycode, keyrecord_t *record) {
+    if (keycode == LATENCY_PROBE) {
+        if (record->event.pressed && !ending) {
+            if (active) {
+                active = false;
+                ending = true;
+            } else {
+                probe_start();
+            }
+        }
+        return false;
+    }
+    if (!active) {
+        return true;
+    }
+    uint8_t  key;
+    uint32_t edge;
+#ifdef COMBO_ENABLE
+    if (IS_COMBOEVENT(record->event)) {
+        if (!record->event.pressed) {
+            return true; // which key's release ended the combo is not known
+        }
+        key  = LATENCY_PROBE_COMBO;
+        edge = last_press_edge;
+    } else
+#endif
+    {
+        keypos_t pos = record->event.key;
+        if (pos.row >= MATRIX_ROWS || pos.col >= MATRIX_COLS) {
+            return true;
+        }
+        key  = pos.row << 4 | pos.col;
+        // A tap-hold key's press comes out after its release edge, so each direction has its own.
+        edge = edge_time[pos.row][pos.col][record->event.pressed];
+    }
+    if (count == LATENCY_PROBE_SIZE) {
+        if (dropped < UINT16_MAX) {
+            dropped++;
+        }
+        return true;
+    }
+    *sample_at(count++) = (sample_t){.edge = edge, .key = key | (record->event.pressed ? LATENCY_PROBE_PRESSED : 0), .state = SAMPLE_PENDING};
+    unreported++;
+    return true;
+}
+
+void latency_probe_task(void) {
+    for (uint8_t i = count - unreported; i < count; i++) {
+        sample_at(i)->state = SAMPLE_NO_REPORT;
+    }
+    unreported = 0;
+    // One line per pass, so that printing delays the scans as little as possible.
+    const sample_t *sample = sample_at(0);
+    if (count && (sample->state == SAMPLE_ACKED || sample->state == SAMPLE_NO_REPORT)) {
+        if (sample->state == SAMPLE_ACKED) {
+            uprintf("latency %02X %08lX %08lX %08lX\n", sample->key, (unsigned long)sample->edge, (unsigned long)sample->queued, (unsigned long)sample->acked);
+        } else {
+            uprintf("latency %02X %08lX\n", sample->key, (unsigned long)sample->edge);
+        }
+        head = (head + 1) % LATENCY_PROBE_SIZE;
+        count--;
+    }
+    if (ending && !count) {
+        uprintf("latency end %u\n", dropped);
+        host_set_driver(original_driver);
+        ending = false;
+    }
+}
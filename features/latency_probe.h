@@ -0,0 +1,46 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  On-device latency measurement.
+ *
+ *  While the test mode is on (toggled with `LATENCY_PROBE`), every key event is timestamped
+ *  three times (µs): when the matrix scan first sees the key's contact change (before
+ *  debouncing), when the keyboard's first report after the event has been processed is queued
+ *  for the USB stack, and when the host has picked that report up (the IN transfer completed).
+ *  The paired timestamps are streamed over the console (capture them with `qmk console`);
+ *  `tools/hwlatency` turns captures into latency distributions per keymap and feature set (see
+ *  tools/readme.md).
+ *
+ *  An event is paired with a report only if the report is sent in the same pass of the main loop
+ *  that processed the event, i.e. once tap-hold or the combo has decided about it. Events that
+ *  send nothing (layer keys, buffered presses) are streamed without a report. A combo counts from
+ *  the contact of its last pressed key. The acknowledgement is polled once per matrix scan.
+ *
+ *  Written for QMK 0.22 on ChibiOS: it wraps the host driver's keyboard, NKRO and extra key
+ *  reports and reads the state of their IN endpoints.
+ */
+
+#ifndef CONSOLE_ENABLE
+#    error "LATENCY_PROBE_ENABLE requires CONSOLE_ENABLE"
+#endif
+
+#ifndef LATENCY_PROBE_SIZE
+#    define LATENCY_PROBE_SIZE 32 // samples waiting to be printed (16 bytes each)
+#endif
+
+#define LATENCY_PROBE_PRESSED 0x80 // in `key`: the event is a press
+#define LATENCY_PROBE_COMBO 0x7F   // `key` of a combo event
+
+// Scans the raw matrix for contact changes and polls the acknowledgements (from
+// `matrix_scan_kb`).
+void latency_probe_scan(void);
+
+// Called once the event has been resolved by tap-hold (from `process_record_kb`). Returns false
+// for `LATENCY_PROBE`.
+bool latency_probe_process(uint16_t keycode, keyrecord_t *record);
+
+// Closes the events of this pass without a report and prints the finished samples (from
+// `housekeeping_task_kb`, before anything there sends reports).
+void latency_probe_task(void);
@@ -0,0 +1,67 @@
+#include "layer_tap_streak.h"
+#include "key_state.h"
+
+static matrix_row_t hold_candidates[MATRIX_ROWS]; // tap-hold keys pressed outside a streak, still down
+static uint16_t     last_streak_press;
+static bool         streak; // whether `last_streak_press` is valid
+
+__attribute__((weak)) uint16_t get_layer_tap_streak_term(uint16_t keycode, keyrecord_t *record) {
+    return LAYER_TAP_STREAK_TERM;
+}
+
+__attribute__((weak)) bool is_layer_tap_streak_key(uint16_t keycode) {
+    switch (keycode) {
+        case KC_A ... KC_Z:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint16_t tap_keycode(uint16_t keycode) {
+    switch (keycode) {
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+            return QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+            return QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+        default:
+            return keycode;
+    }
+}
+
+static bool hold_candidate_down(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (hold_candidates[row]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void layer_tap_streak_record(uint16_t keycode, keyrecord_t *record) {
+    keypos_t key = record->event.key;
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return; // not a matrix event (e.g. a combo)
+    }
+    matrix_row_t bit = (matrix_row_t)1 << key.col;
+
+    if (!record->event.pressed) {
+        hold_candidates[key.row] &= ~bit; // key_state rewrites the release of a suppressed key
+        return;
+    }
+
+    uint16_t since_streak = TIMER_DIFF_16(record->event.time, last_streak_press);
+    if (IS_QK_LAYER_TAP(keycode) && streak && since_streak < get_layer_tap_streak_term(keycode, record) && !hold_candidate_down()) {
+        key_state_rewrite(record, tap_keycode(keycode));
+    } else if ((IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && !record->keycode && !(streak && since_streak < LAYER_TAP_STREAK_TERM)) {
+        // Tap-hold keys rolled within a word are taps; anything else may be held on purpose.
+        hold_candidates[key.row] |= bit;
+    }
+
+    if (get_mods() & ~MOD_MASK_SHIFT) {
+        streak = false; // shortcuts (e.g. Ctrl+N) are not typing
+    } else if (is_layer_tap_streak_key(tap_keycode(keycode))) {
+        last_streak_press = record->event.time;
+        streak            = true;
+    }
+}
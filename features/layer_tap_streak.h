@@ -0,0 +1,36 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Streak suppression for layer-taps.
+ *
+ *  While a word is being typed, a layer-tap key is hardly ever meant as a hold. A layer-tap that
+ *  goes down within `get_layer_tap_streak_term()` ms of the last alpha key press is therefore
+ *  turned into its tap keycode before combos and tap-hold see it: the tap is sent without waiting
+ *  for the tap-hold decision, and the layer cannot come on by accident. Combos still see the
+ *  layer-tap keycode.
+ *
+ *  The window is independent of the tapping term and only applies to layer-taps; mod-taps are
+ *  left to tap-hold. A layer-tap is not suppressed while a tap-hold key is down that was pressed
+ *  outside a streak (within LAYER_TAP_STREAK_TERM of an alpha), so that holds can still be
+ *  chained.
+ */
+
+#if !defined(COMBO_ENABLE) && !defined(REPEAT_KEY_ENABLE)
+#    error "layer_tap_streak requires COMBO_ENABLE (keyrecord_t.keycode)"
+#endif
+
+#ifndef LAYER_TAP_STREAK_TERM
+#    define LAYER_TAP_STREAK_TERM 150 // ms
+#endif
+
+// Called for every key event before combos and tap-hold see it.
+void layer_tap_streak_record(uint16_t keycode, keyrecord_t *record);
+
+// Streak window of a layer-tap, 0 disables the suppression. Default: LAYER_TAP_STREAK_TERM.
+uint16_t get_layer_tap_streak_term(uint16_t keycode, keyrecord_t *record);
+
+// Whether a key press continues a streak. `keycode` is the tap keycode for tap-hold keys.
+// Default: the letters A-Z.
+bool is_layer_tap_streak_key(uint16_t keycode);
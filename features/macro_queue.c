@@ -0,0 +1,57 @@
+#include "macro_queue.h"
+
+typedef struct {
+    uint16_t keycode;
+    bool     pressed;
+} macro_action_t;
+
+static macro_action_t queue[MACRO_QUEUE_SIZE];
+static uint8_t        head;  // index of the next action to send
+static uint8_t        count; // number of queued actions
+static uint16_t       last_sent;
+
+static void send_next(void) {
+    macro_action_t *action = &queue[head];
+    if (action->pressed) {
+        register_code16(action->keycode);
+    } else {
+        unregister_code16(action->keycode);
+    }
+    head = (head + 1) % MACRO_QUEUE_SIZE;
+    count--;
+    last_sent = timer_read();
+}
+
+static void push(uint16_t keycode, bool pressed) {
+    if (count == MACRO_QUEUE_SIZE) {
+        while (count) {
+            send_next();
+            wait_ms(MACRO_QUEUE_INTERVAL);
+        }
+    }
+    queue[(head + count) % MACRO_QUEUE_SIZE] = (macro_action_t){.keycode = keycode, .pressed = pressed};
+    count++;
+}
+
+void macro_queue_register(uint16_t keycode) {
+    push(keycode, true);
+}
+
+void macro_queue_unregister(uint16_t keycode) {
+    push(keycode, false);
+}
+
+void macro_queue_tap(uint16_t keycode) {
+    push(keycode, true);
+    push(keycode, false);
+}
+
+bool macro_queue_busy(void) {
+    return count > 0;
+}
+
+void macro_queue_task(void) {
+    if (count && timer_elapsed(last_sent) >= MACRO_QUEUE_INTERVAL) {
+        send_next();
+    }
+}
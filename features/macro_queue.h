@@ -0,0 +1,34 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Non-blocking macros.
+ *
+ *  `tap_code()` and friends send their reports one after the other before they return, so a
+ *  macro stalls the scan loop for as long as it takes. Here, the key downs and ups of a macro are
+ *  queued instead and sent from the housekeeping task, one per MACRO_QUEUE_INTERVAL, while keys
+ *  are scanned and processed as usual.
+ *
+ *  Keys typed while a macro plays are sent in between its reports. Macros should therefore not
+ *  hold a modifier across several reports if that could affect other keys. If the queue is full,
+ *  it is drained right away (blocking, as before) to keep the order of the reports.
+ */
+
+#ifndef MACRO_QUEUE_SIZE
+#    define MACRO_QUEUE_SIZE 32 // number of key downs and ups
+#endif
+
+#ifndef MACRO_QUEUE_INTERVAL
+#    define MACRO_QUEUE_INTERVAL 1 // ms between two reports (the USB polling interval)
+#endif
+
+void macro_queue_register(uint16_t keycode);
+void macro_queue_unregister(uint16_t keycode);
+void macro_queue_tap(uint16_t keycode);
+
+// Whether a macro is still playing.
+bool macro_queue_busy(void);
+
+// Called from `housekeeping_task_kb`.
+void macro_queue_task(void);
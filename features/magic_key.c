@@ -0,0 +1,35 @@
+#include "magic_key.h"
+#include "print.h"
+
+void magic_key_init(void) {
+    for (uint8_t i = 1; i < magic_key_table_count; i++) {
+        if (pgm_read_word(&magic_key_table[i - 1].previous) >= pgm_read_word(&magic_key_table[i].previous)) {
+            uprintf("magic_key: table not sorted at entry %u\n", i);
+        }
+    }
+}
+
+uint16_t magic_key_lookup(uint16_t keycode, uint8_t mods) {
+    if (mods & ~MOD_MASK_SHIFT) {
+        return KC_TRANSPARENT;
+    }
+    if (IS_QK_MOD_TAP(keycode)) {
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    } else if (IS_QK_LAYER_TAP(keycode)) {
+        keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    uint8_t low = 0, high = magic_key_table_count;
+    while (low < high) {
+        uint8_t  middle   = low + (high - low) / 2;
+        uint16_t previous = pgm_read_word(&magic_key_table[middle].previous);
+        if (previous == keycode) {
+            return pgm_read_word(&magic_key_table[middle].next);
+        }
+        if (previous < keycode) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return KC_TRANSPARENT;
+}
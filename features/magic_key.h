@@ -0,0 +1,47 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Magic key.
+ *
+ *  A key whose output depends on the key typed before it, so that a same-finger bigram can be
+ *  typed with the other hand: e.g. with T after G, "gt" becomes G followed by a magic key on the
+ *  right hand. The pairs are given by a constant table in the keymap, sorted by `previous` (as a
+ *  number), and looked up by binary search:
+ *
+ *      const magic_key_entry_t PROGMEM magic_key_table[] = {
+ *          // previous  next
+ *          {DE_G,       DE_T},
+ *          {DE_COMMA,   DE_MINUS},
+ *      };
+ *      const uint8_t magic_key_table_count = ARRAY_SIZE(magic_key_table);
+ *
+ *      uint16_t get_alt_repeat_key_keycode_user(uint16_t keycode, uint8_t mods) {
+ *          return magic_key_lookup(keycode, mods);
+ *      }
+ *
+ *  The magic key is QMK's Alternate Repeat Key (QK_AREP), so the previous key is the last key
+ *  kept for the Repeat Key: mod-taps and layer-taps count with their tap keycode, and combos and
+ *  overrides with their output. After Ctrl, Alt or GUI, and for keys without an entry, QMK's own
+ *  alternates apply. `next` is sent without the modifiers of the previous key.
+ */
+
+#ifndef REPEAT_KEY_ENABLE
+#    error "magic_key requires REPEAT_KEY_ENABLE"
+#endif
+
+typedef struct {
+    uint16_t previous;
+    uint16_t next;
+} magic_key_entry_t;
+
+// Defined by the keymap.
+extern const magic_key_entry_t magic_key_table[];
+extern const uint8_t           magic_key_table_count;
+
+// Checks the order of the table (from `keyboard_post_init_kb`), printing a message if unsorted.
+void magic_key_init(void);
+
+// The keycode that follows `keycode`, or KC_TRANSPARENT if there is none.
+uint16_t magic_key_lookup(uint16_t keycode, uint8_t mods);
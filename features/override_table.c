@@ -0,0 +1,115 @@
+#include "override_table.h"
+
+#define NONE 0xFF
+
+// First entry of each bucket and the entry that follows in the same bucket:
+static uint8_t first[256];
+static uint8_t next[OVERRIDE_TABLE_SIZE];
+static uint8_t mods_in_use; // left/right-folded trigger mods of all entries
+static bool    unconditional; // some entry has no trigger mods
+
+static const override_table_entry_t *active;
+static keypos_t                      active_key;
+static uint8_t                       suppressed; // trigger mods taken off while `active`
+
+// Folds an 8-bit modifier mask to its 4 bits without left/right.
+static uint8_t fold_mods(uint8_t mods) {
+    return (mods | mods >> 4) & 0x0F;
+}
+
+void override_table_init(void) {
+    memset(first, NONE, sizeof(first));
+    uint8_t count = MIN(override_table_count, OVERRIDE_TABLE_SIZE);
+    // Entries are chained in reverse so that each bucket keeps the order of the table.
+    for (uint8_t i = count; i-- > 0;) {
+        uint8_t bucket = pgm_read_word(&override_table[i].trigger) & 0xFF;
+        uint8_t mods   = fold_mods(pgm_read_byte(&override_table[i].trigger_mods));
+        next[i]        = first[bucket];
+        first[bucket]  = i;
+        mods_in_use |= mods;
+        unconditional |= !mods;
+    }
+}
+
+static void deactivate(void) {
+    if (!active) {
+        return;
+    }
+    unregister_code16(pgm_read_word(&active->replacement));
+    add_mods(suppressed);
+    send_keyboard_report();
+    active     = NULL;
+    suppressed = 0;
+}
+
+// Modifiers that a key adds while held:
+static uint8_t modifiers_of(uint16_t keycode, keyrecord_t *record) {
+    if (IS_MODIFIER_KEYCODE(keycode)) {
+        return MOD_BIT(keycode);
+    }
+    if (IS_QK_MOD_TAP(keycode) && record->tap.count == 0) {
+        uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+        return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+    }
+    return 0;
+}
+
+static bool matches(const override_table_entry_t *entry, uint16_t keycode, uint8_t mods, layer_state_t layer) {
+    if (entry->trigger != keycode || !(entry->layers & layer)) {
+        return false;
+    }
+    uint8_t required = fold_mods(entry->trigger_mods);
+    return (fold_mods(mods) & required) == required && !(mods & entry->negative_mods);
+}
+
+bool override_table_process(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        // A released modifier must not come back when the override ends.
+        suppressed &= ~modifiers_of(keycode, record);
+        if (active && KEYEQ(record->event.key, active_key)) {
+            deactivate();
+            return false;
+        }
+        return true;
+    }
+
+    deactivate();
+    uint8_t index = first[keycode & 0xFF];
+    if (index == NONE) {
+        return true;
+    }
+    uint8_t mods = get_mods() | get_weak_mods();
+#ifndef NO_ACTION_ONESHOT
+    mods |= get_oneshot_mods();
+#endif
+    if (!unconditional && !(fold_mods(mods) & mods_in_use)) {
+        return true;
+    }
+    if ((IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && record->tap.count == 0) {
+        return true; // holds never trigger an override
+    }
+    layer_state_t layer = (layer_state_t)1 << get_highest_layer(layer_state | default_layer_state);
+    for (; index != NONE; index = next[index]) {
+        override_table_entry_t entry;
+        memcpy_P(&entry, &override_table[index], sizeof(entry));
+        if (!matches(&entry, keycode, mods, layer)) {
+            continue;
+        }
+        active     = &override_table[index];
+        active_key = record->event.key;
+        suppressed = get_mods() & entry.trigger_mods;
+        del_mods(suppressed);
+        del_weak_mods(entry.trigger_mods);
+#ifndef NO_ACTION_ONESHOT
+        clear_oneshot_mods();
+#endif
+        register_code16(entry.replacement);
+#ifdef REPEAT_KEY_ENABLE
+        // The Repeat Key repeats what was sent, not the trigger:
+        set_last_keycode(entry.replacement);
+        set_last_mods(get_mods());
+#endif
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Indexed key overrides.
+ *
+ *  A replacement for QMK's key overrides whose cost per key event does not grow with the number
+ *  of overrides. The overrides are given by a constant table in the keymap; at start-up they are
+ *  indexed by the low byte of their trigger keycode, and the modifiers of all overrides are
+ *  merged into one mask. A key press only looks at the overrides of its own index bucket, and
+ *  not even at those if none of their modifiers is held.
+ *
+ *  Semantics follow QMK's default options: an override activates on the press of its trigger
+ *  while all of `trigger_mods` (left or right) and none of `negative_mods` are held, and only on
+ *  `layers`. The trigger mods are taken off for the replacement and come back when the trigger
+ *  is released or another key is pressed. The trigger is not registered again afterwards. With
+ *  REPEAT_KEY_ENABLE, the replacement becomes the last key for the Repeat Key.
+ *
+ *      const override_table_entry_t PROGMEM override_table[] = {
+ *          // trigger  trigger mods    replacement  layers    negative mods
+ *          {DE_COMMA,  MOD_MASK_SHIFT, DE_DASH,     PUQ_MASK, MOD_MASK_CAG},
+ *      };
+ *      const uint8_t override_table_count = ARRAY_SIZE(override_table);
+ *
+ *  `CUSTOM_SHIFT()` makes an entry for the common case of a key with another shifted keycode.
+ */
+
+#ifndef OVERRIDE_TABLE_SIZE
+#    define OVERRIDE_TABLE_SIZE 64 // maximum number of table entries
+#endif
+
+#define OVERRIDE_ALL_LAYERS ((layer_state_t)~0)
+
+// Shift+`base` sends `shifted` (which may have modifiers itself) on all layers:
+#define CUSTOM_SHIFT(base, shifted) \
+    { (base), MOD_MASK_SHIFT, (shifted), OVERRIDE_ALL_LAYERS, 0 }
+
+typedef struct {
+    uint16_t      trigger;
+    uint8_t       trigger_mods;  // 8-bit mask (MOD_MASK_SHIFT, ...)
+    uint16_t      replacement;
+    layer_state_t layers;        // layer masks, checked against the highest active layer
+    uint8_t       negative_mods; // 8-bit mask
+} override_table_entry_t;
+
+// Defined by the keymap.
+extern const override_table_entry_t override_table[];
+extern const uint8_t                override_table_count;
+
+// Builds the index (from `keyboard_post_init_kb`).
+void override_table_init(void);
+
+// Called for every key event after `process_record_user`.
+bool override_table_process(uint16_t keycode, keyrecord_t *record);
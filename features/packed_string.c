@@ -0,0 +1,68 @@
+#include "packed_string.h"
+
+static uint8_t held_key;  // key of the previous character, still down
+static uint8_t held_mods; // weak modifiers of the previous character, still down
+
+static void send_packed_report(void) {
+    send_keyboard_report();
+#if TAP_CODE_DELAY > 0
+    wait_ms(TAP_CODE_DELAY);
+#endif
+}
+
+static void release_held(void) {
+    if (held_key) {
+        del_key(held_key);
+        send_packed_report();
+        held_key = KC_NO;
+    }
+}
+
+// Whether all characters can be packed.
+static bool packable(const char *string) {
+    for (; *string; string++) {
+        uint8_t c = *string;
+        if (c == SS_QMK_PREFIX || (c < 128 && PGM_LOADBIT(ascii_to_dead_lut, c))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void send_string_packed(const char *string) {
+    if (!keymap_config.nkro || !packable(string)) {
+        send_string(string);
+        return;
+    }
+    for (; *string; string++) {
+        uint8_t c = *string;
+        if (c >= 128) {
+            continue;
+        }
+        uint8_t keycode = pgm_read_byte(&ascii_to_keycode_lut[c]);
+        if (!keycode) {
+            continue;
+        }
+        uint8_t mods = (PGM_LOADBIT(ascii_to_shift_lut, c) ? MOD_BIT(KC_LEFT_SHIFT) : 0) | (PGM_LOADBIT(ascii_to_altgr_lut, c) ? MOD_BIT(KC_RIGHT_ALT) : 0);
+        if (keycode == held_key || mods != held_mods) {
+            release_held(); // the host would not see the press, or would see it with other mods
+        }
+        if (held_key) {
+            del_key(held_key);
+        }
+        del_weak_mods(held_mods);
+        add_weak_mods(mods);
+        add_key(keycode);
+        send_packed_report();
+        held_key  = keycode;
+        held_mods = mods;
+    }
+    // The last key and its modifiers go up together.
+    if (held_key) {
+        del_key(held_key);
+    }
+    del_weak_mods(held_mods);
+    send_packed_report();
+    held_key  = KC_NO;
+    held_mods = 0;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Packed strings.
+ *
+ *  `SEND_STRING()` sends every character as a press report and a release report, plus two more for
+ *  the modifiers of shifted characters. With NKRO, `send_string_packed()` releases a character in
+ *  the same report that presses the next one, and keeps the modifiers down for a run of characters
+ *  that need the same ones. The host sees every new key in the right order, and a string of
+ *  distinct characters takes one report per character plus one.
+ *
+ *  A character is released on its own before the next one if both are on the same key or need
+ *  other modifiers. Without NKRO, and for strings with SS_ codes or dead keys, the string is sent
+ *  by `send_string()`. QMK boots without NKRO unless it was turned on and saved, so keymaps that
+ *  rely on packing should define FORCE_NKRO.
+ */
+
+void send_string_packed(const char *string);
+
+#define SEND_STRING_PACKED(string) send_string_packed(string)
@@ -0,0 +1,29 @@
+#include "release_hold.h"
+#include "key_state.h"
+
+// How long the most recently released key was held down:
+static uint16_t release_overlap;
+
+void release_hold_record(keyrecord_t *record) {
+    key_state_t *key = key_state(record->event.key);
+    if (!key || record->event.pressed) {
+        return; // presses are recorded by key_state; not a matrix event (e.g. a combo)
+    }
+    // The tap-hold key was pressed before this key (otherwise PERMISSIVE_HOLD would not ask), so
+    // the overlap of both keys is the time this key was held.
+    release_overlap = TIMER_DIFF_16(record->event.time, key->time);
+}
+
+#ifdef RELEASE_HOLD_MIN_OVERLAP_PER_KEY
+__attribute__((weak)) uint16_t get_release_hold_min_overlap(uint16_t keycode, keyrecord_t *record) {
+    return RELEASE_HOLD_MIN_OVERLAP;
+}
+#endif
+
+bool get_release_hold(uint16_t keycode, keyrecord_t *record) {
+#ifdef RELEASE_HOLD_MIN_OVERLAP_PER_KEY
+    return release_overlap >= get_release_hold_min_overlap(keycode, record);
+#else
+    return release_overlap >= RELEASE_HOLD_MIN_OVERLAP;
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Release-order hold resolution.
+ *
+ *  A tap-hold key becomes a hold only if another key is pressed *and released* while it is still
+ *  down, and that other key was held for at least RELEASE_HOLD_MIN_OVERLAP ms. Fast rolls, where
+ *  the interrupting key is released only after the tap-hold key, or is merely brushed, stay taps.
+ *
+ *  The decision hooks into PERMISSIVE_HOLD: return `get_release_hold(keycode, record)` from
+ *  `get_permissive_hold()` for every key that should use this strategy. Key timings are taken
+ *  from the key events as they arrive (see features/key_state.h), so the scan loop is not touched.
+ */
+
+#if !defined(PERMISSIVE_HOLD_PER_KEY)
+#    error "release_hold requires PERMISSIVE_HOLD_PER_KEY"
+#endif
+
+#ifndef RELEASE_HOLD_MIN_OVERLAP
+#    define RELEASE_HOLD_MIN_OVERLAP 30 // ms
+#endif
+
+// Record the timing of a key event. Called for every event before combos and tap-hold see it.
+void release_hold_record(keyrecord_t *record);
+
+// Decide whether the tap-hold key `keycode` is a hold, given the key release being processed.
+bool get_release_hold(uint16_t keycode, keyrecord_t *record);
+
+#ifdef RELEASE_HOLD_MIN_OVERLAP_PER_KEY
+uint16_t get_release_hold_min_overlap(uint16_t keycode, keyrecord_t *record);
+#endif
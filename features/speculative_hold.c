@@ -0,0 +1,78 @@
+#include "speculative_hold.h"
+
+typedef struct {
+    keypos_t key;
+    uint8_t  mods; // 8-bit modifier mask; 0 if the slot is free
+} speculative_key_t;
+
+static speculative_key_t speculative_keys[SPECULATIVE_HOLD_MAX_KEYS];
+static uint8_t           keys_down;
+
+// Converts the 5-bit modifier encoding of a mod-tap keycode into an 8-bit modifier mask.
+static uint8_t mod_tap_mods(uint16_t keycode) {
+    uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+}
+
+__attribute__((weak)) bool get_speculative_hold(uint16_t keycode, keyrecord_t *record) {
+    return (mod_tap_mods(keycode) & ~MOD_MASK_SHIFT) == 0;
+}
+
+static speculative_key_t *find_key(keypos_t key) {
+    for (uint8_t i = 0; i < SPECULATIVE_HOLD_MAX_KEYS; i++) {
+        if (speculative_keys[i].mods && KEYEQ(speculative_keys[i].key, key)) {
+            return &speculative_keys[i];
+        }
+    }
+    return NULL;
+}
+
+static speculative_key_t *free_slot(void) {
+    for (uint8_t i = 0; i < SPECULATIVE_HOLD_MAX_KEYS; i++) {
+        if (!speculative_keys[i].mods) {
+            return &speculative_keys[i];
+        }
+    }
+    return NULL;
+}
+
+void speculative_hold_record(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        if (keys_down) keys_down--;
+        return;
+    }
+    // Keys that are already down may still be buffered and must not pick up the modifier. Only
+    // other speculating keys are fine, since their modifiers are in the report already.
+    uint8_t speculating = 0;
+    for (uint8_t i = 0; i < SPECULATIVE_HOLD_MAX_KEYS; i++) {
+        if (speculative_keys[i].mods) speculating++;
+    }
+    bool others_buffered = keys_down++ > speculating;
+    if (others_buffered || !IS_QK_MOD_TAP(keycode) || !get_speculative_hold(keycode, record)) {
+        return;
+    }
+    speculative_key_t *slot = free_slot();
+    if (slot) {
+        slot->key  = record->event.key;
+        slot->mods = mod_tap_mods(keycode);
+        register_mods(slot->mods);
+    }
+}
+
+void speculative_hold_resolve(uint16_t keycode, keyrecord_t *record) {
+    speculative_key_t *slot = IS_QK_MOD_TAP(keycode) ? find_key(record->event.key) : NULL;
+    if (!slot) {
+        return;
+    }
+    uint8_t mods = slot->mods;
+    slot->mods   = 0;
+    if (record->event.pressed && record->tap.count == 0) {
+        // Resolved as hold: tap-hold registers the same modifiers and takes care of them.
+        return;
+    }
+    // Resolved as tap: withdraw the modifiers, unless another speculating key still needs them.
+    for (uint8_t i = 0; i < SPECULATIVE_HOLD_MAX_KEYS; i++) {
+        mods &= ~speculative_keys[i].mods;
+    }
+    unregister_mods(mods);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Speculative modifier registration for mod-taps.
+ *
+ *  For mod-taps whose modifier is harmless on its own (Shift), the modifier is added to the HID
+ *  report as soon as the key goes down instead of after the tap-hold decision. If the key
+ *  resolves to a hold, nothing changes; if it resolves to a tap, the modifier is withdrawn before
+ *  the tap keycode is sent.
+ *
+ *  Speculation only starts when no other key is down. Otherwise combos or tap-hold could still be
+ *  buffering earlier keys, which would then be sent with the modifier.
+ */
+
+#ifndef SPECULATIVE_HOLD_MAX_KEYS
+#    define SPECULATIVE_HOLD_MAX_KEYS 2
+#endif
+
+// Called for every key event before combos and tap-hold see it.
+void speculative_hold_record(uint16_t keycode, keyrecord_t *record);
+
+// Called once the event has been resolved by tap-hold (from `process_record_kb`).
+void speculative_hold_resolve(uint16_t keycode, keyrecord_t *record);
+
+// Which mod-taps register their modifier early. Default: mod-taps with only Shift as modifier.
+bool get_speculative_hold(uint16_t keycode, keyrecord_t *record);
@@ -0,0 +1,117 @@
+#include "tap_dance_table.h"
+#ifdef TRACE_ENABLE
+#    include "trace.h"
+#endif
+
+typedef enum {
+    OUTCOME_NONE,
+    OUTCOME_TAP,
+    OUTCOME_HOLD,
+    OUTCOME_DOUBLE_TAP,
+    OUTCOME_EAGER_TAP, // registered on the press, unregistered on its release
+} outcome_t;
+
+// What each dance has registered, to be undone by its reset:
+static uint8_t outcomes[TAP_DANCE_TABLE_SIZE];
+
+static void register_hold(uint16_t hold) {
+    if (IS_QK_MOMENTARY(hold)) {
+        layer_on(QK_MOMENTARY_GET_LAYER(hold));
+    } else {
+        register_code16(hold);
+    }
+}
+
+static void unregister_hold(uint16_t hold) {
+    if (IS_QK_MOMENTARY(hold)) {
+        layer_off(QK_MOMENTARY_GET_LAYER(hold));
+    } else {
+        unregister_code16(hold);
+    }
+}
+
+void tap_dance_table_on_each_tap(tap_dance_state_t *state, void *user_data) {
+    uint8_t index = (uintptr_t)user_data;
+    if (index >= TAP_DANCE_TABLE_SIZE) {
+        return;
+    }
+    bool     eager      = pgm_read_byte(&tap_dance_table[index].eager);
+    uint16_t double_tap = pgm_read_word(&tap_dance_table[index].double_tap);
+    if (state->count == 1 || (eager && !double_tap)) {
+        if (eager) { // without a double tap, every press is sent on its own
+            outcomes[index] = OUTCOME_EAGER_TAP;
+            register_code16(pgm_read_word(&tap_dance_table[index].tap));
+        }
+        return;
+    }
+    if (!double_tap) {
+        tap_code16(pgm_read_word(&tap_dance_table[index].tap)); // the previous tap
+    } else if (state->count == 2) {
+#ifdef TRACE_ENABLE
+        trace_tap_dance(state);
+#endif
+        uint16_t undo = pgm_read_word(&tap_dance_table[index].undo);
+        if (eager && undo) {
+            tap_code16(undo);
+        }
+        outcomes[index] = OUTCOME_DOUBLE_TAP;
+        register_code16(double_tap);
+        state->finished = true;
+    }
+}
+
+void tap_dance_table_finished(tap_dance_state_t *state, void *user_data) {
+    uint8_t index = (uintptr_t)user_data;
+    if (index >= TAP_DANCE_TABLE_SIZE) {
+        return;
+    }
+#ifdef TRACE_ENABLE
+    trace_tap_dance(state);
+#endif
+    bool eager = pgm_read_byte(&tap_dance_table[index].eager);
+    if (eager && (state->count == 1 || !pgm_read_word(&tap_dance_table[index].double_tap))) {
+        return; // sent on the press
+    }
+    uint16_t hold = pgm_read_word(&tap_dance_table[index].hold);
+    if (state->count == 1 && state->pressed && !state->interrupted && hold) {
+        outcomes[index] = OUTCOME_HOLD;
+        register_hold(hold);
+    } else {
+        outcomes[index] = OUTCOME_TAP;
+        register_code16(pgm_read_word(&tap_dance_table[index].tap));
+    }
+}
+
+void tap_dance_table_reset(tap_dance_state_t *state, void *user_data) {
+    uint8_t index = (uintptr_t)user_data;
+    if (index >= TAP_DANCE_TABLE_SIZE) {
+        return;
+    }
+    switch (outcomes[index]) {
+        case OUTCOME_TAP:
+            unregister_code16(pgm_read_word(&tap_dance_table[index].tap));
+            break;
+        case OUTCOME_HOLD:
+            unregister_hold(pgm_read_word(&tap_dance_table[index].hold));
+            break;
+        case OUTCOME_DOUBLE_TAP:
+            unregister_code16(pgm_read_word(&tap_dance_table[index].double_tap));
+            break;
+        case OUTCOME_EAGER_TAP:
+            unregister_code16(pgm_read_word(&tap_dance_table[index].tap));
+            break;
+        default:
+            break;
+    }
+    outcomes[index] = OUTCOME_NONE;
+}
+
+void tap_dance_table_on_each_release(tap_dance_state_t *state, void *user_data) {
+    uint8_t index = (uintptr_t)user_data;
+    if (index >= TAP_DANCE_TABLE_SIZE || outcomes[index] != OUTCOME_EAGER_TAP) {
+        return;
+    }
+    // The dance may go on with a second tap, so the eager tap cannot wait for the reset.
+    outcomes[index] = OUTCOME_NONE;
+    unregister_code16(pgm_read_word(&tap_dance_table[index].tap));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Table-driven tap dances.
+ *
+ *  A tap dance is described by one constant entry of `tap_dance_table[]`: the keycode sent on a
+ *  tap, the modifier (e.g. KC_LGUI) or layer (MO(n)) that is active while the key is held, and the
+ *  keycode sent on a double tap. This covers mod-taps and layer-taps with shifted tap keycodes,
+ *  which MT and LT do not support, as well as the pairs of ACTION_TAP_DANCE_DOUBLE.
+ *
+ *  An eager dance sends its tap as soon as the key goes down instead of waiting for a second tap.
+ *  If the second tap follows, the `undo` keycode (e.g. KC_BSPC) is tapped to take back the first
+ *  one before the double-tap keycode is sent. With KC_NO the first tap stays and has already taken
+ *  effect, so only make a dance eager if its tap is harmless or can be undone (not e.g. for F-keys,
+ *  where F1 would fire before F11). An eager dance without a double tap sends every press on its
+ *  own. Eager dances should have no hold.
+ *
+ *  All entries share the same callbacks. The outcome of each dance is kept in a slot of its own,
+ *  so dances that overlap do not disturb each other. The table is indexed like
+ *  `tap_dance_actions[]`:
+ *
+ *      const tap_dance_table_entry_t PROGMEM tap_dance_table[] = {
+ *          [TD_NEO4_SLASH] = {DE_SLASH, MO(NEO4), KC_NO},
+ *          [TD_F01_F11]    = {KC_F1, KC_NO, KC_F11},
+ *          [TD_COMM_SCLN]  = {KC_COMMA, KC_NO, KC_SCLN, true, KC_BSPC},
+ *      };
+ *      tap_dance_action_t tap_dance_actions[] = {
+ *          [TD_NEO4_SLASH] = ACTION_TAP_DANCE_TABLE(TD_NEO4_SLASH),
+ *          [TD_F01_F11]    = ACTION_TAP_DANCE_TABLE(TD_F01_F11),
+ *          [TD_COMM_SCLN]  = ACTION_TAP_DANCE_TABLE(TD_COMM_SCLN),
+ *      };
+ */
+
+#ifndef TAP_DANCE_ENABLE
+#    error "tap_dance_table requires TAP_DANCE_ENABLE"
+#endif
+
+#ifndef TAP_DANCE_TABLE_SIZE
+#    define TAP_DANCE_TABLE_SIZE 32 // maximum number of table entries
+#endif
+
+typedef struct {
+    uint16_t tap;        // sent on a tap, and while held if `hold` is KC_NO
+    uint16_t hold;       // modifier keycode or MO(layer) while held, KC_NO for none
+    uint16_t double_tap; // sent on the second tap, KC_NO: every tap sends `tap`
+    bool     eager;      // send the tap on the press, without waiting for a second tap
+    uint16_t undo;       // eager dances: tapped before the double tap, KC_NO: keep the first tap
+} tap_dance_table_entry_t;
+
+// Defined by the keymap.
+extern const tap_dance_table_entry_t tap_dance_table[];
+
+void tap_dance_table_on_each_tap(tap_dance_state_t *state, void *user_data);
+void tap_dance_table_finished(tap_dance_state_t *state, void *user_data);
+void tap_dance_table_reset(tap_dance_state_t *state, void *user_data);
+void tap_dance_table_on_each_release(tap_dance_state_t *state, void *user_data);
+
+#define ACTION_TAP_DANCE_TABLE(index) \
+    { .fn = {tap_dance_table_on_each_tap, tap_dance_table_finished, tap_dance_table_reset, tap_dance_table_on_each_release}, .user_data = (void *)(uintptr_t)(index), }
@@ -0,0 +1,119 @@
+#include "trace.h"
+#include "print.h"
+#include "zilpzalp.h"
+#ifdef PROTOCOL_CHIBIOS
+#    include <ch.h>
+#endif
+
+static trace_entry_t trace[TRACE_SIZE];
+static uint16_t      trace_head;  // index of the oldest entry
+static uint16_t      trace_count; // number of entries in the buffer
+static bool          dumping;     // recording pauses while the buffer is printed
+#ifdef TAP_DANCE_ENABLE
+static uint16_t last_tap_dance; // keycode of the most recently pressed tap dance key
+#endif
+
+static uint32_t trace_time_us(void) {
+#ifdef PROTOCOL_CHIBIOS
+    return TIME_I2US(chVTGetSystemTimeX());
+#else
+    return timer_read32() * 1000;
+#endif
+}
+
+static void trace_add(trace_kind_t kind, uint8_t key, uint16_t keycode) {
+    if (dumping) {
+        return;
+    }
+    trace_entry_t *entry = &trace[(trace_head + trace_count) % TRACE_SIZE];
+    if (trace_count < TRACE_SIZE) {
+        trace_count++;
+    } else {
+        trace_head = (trace_head + 1) % TRACE_SIZE; // overwrite the oldest entry
+    }
+    entry->time    = trace_time_us();
+    entry->keycode = keycode;
+    entry->key     = key;
+    entry->kind    = kind;
+}
+
+static uint8_t trace_key(keypos_t key) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return 0xFF;
+    }
+    return key.row << 4 | key.col;
+}
+
+void trace_record(uint16_t keycode, keyrecord_t *record) {
+    uint8_t key = trace_key(record->event.key);
+    if (key == 0xFF) {
+        return; // not a matrix event (e.g. a combo)
+    }
+    trace_add(record->event.pressed ? TRACE_PRESS : TRACE_RELEASE, key, keycode);
+}
+
+bool trace_resolve(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        return true;
+    }
+#ifdef COMBO_ENABLE
+    if (IS_COMBOEVENT(record->event)) {
+        trace_add(TRACE_COMBO, 0xFF, keycode);
+        return true;
+    }
+#endif
+    switch (keycode) {
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+            trace_add(record->tap.count ? TRACE_TAP : TRACE_HOLD, trace_key(record->event.key), keycode);
+            return true;
+#ifdef TAP_DANCE_ENABLE
+        case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:
+            last_tap_dance = keycode;
+            return true;
+#endif
+        case TRACE_DUMP:
+            if (!dumping && trace_count) {
+                uprintf("trace begin %u tapping_term=%u", trace_count, TAPPING_TERM);
+#ifdef COMBO_ENABLE
+                uprintf(" combo_term=%u", COMBO_TERM);
+#endif
+#ifdef PERMISSIVE_HOLD
+                print(" permissive_hold");
+#endif
+#ifdef HOLD_ON_OTHER_KEY_PRESS
+                print(" hold_on_other_key_press");
+#endif
+                print("\n");
+                dumping = true;
+            }
+            return false;
+        default:
+            return true;
+    }
+}
+
+#ifdef TAP_DANCE_ENABLE
+void trace_tap_dance(tap_dance_state_t *state) {
+    uint8_t data = (state->count & 0x0F) | (state->pressed ? 0x80 : 0) | (state->interrupted ? 0x40 : 0);
+    trace_add(TRACE_TAP_DANCE, data, last_tap_dance);
+}
+#endif
+
+void trace_task(void) {
+    if (!dumping) {
+        return;
+    }
+    // The console is slow. Printing a few lines per pass keeps the keyboard responsive.
+    for (uint8_t i = 0; i < TRACE_DUMP_BATCH && trace_count; i++) {
+        trace_entry_t *entry = &trace[trace_head];
+        uprintf("trace %08lX %u %02X %04X\n", (unsigned long)entry->time, entry->kind, entry->key, entry->keycode);
+        trace_head = (trace_head + 1) % TRACE_SIZE;
+        trace_count--;
+    }
+    if (!trace_count) {
+        print("trace end\n");
+        trace_head = 0;
+        dumping    = false;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ *  Tap-hold event trace.
+ *
+ *  Records the raw key events (matrix position, press/release, µs timestamp) in a RAM ring
+ *  buffer, together with the decisions that tap-hold, combos and tap dance made about them.
+ *  Pressing `TRACE_DUMP` prints the buffer over the console (capture it with `qmk console`) and
+ *  empties it. `tools/replay` feeds such a capture through the keymap compiled for the host with
+ *  other settings and lists the decisions that change (see tools/readme.md).
+ */
+
+#ifndef CONSOLE_ENABLE
+#    error "TRACE_ENABLE requires CONSOLE_ENABLE"
+#endif
+
+#ifndef TRACE_SIZE
+#    define TRACE_SIZE 512 // number of entries (8 bytes each)
+#endif
+
+#ifndef TRACE_DUMP_BATCH
+#    define TRACE_DUMP_BATCH 4 // entries printed per housekeeping pass while dumping
+#endif
+
+typedef enum {
+    TRACE_PRESS,     // raw key event
+    TRACE_RELEASE,   // raw key event
+    TRACE_TAP,       // tap-hold key resolved as tap; keycode: the tap-hold key
+    TRACE_HOLD,      // tap-hold key resolved as hold; keycode: the tap-hold key
+    TRACE_COMBO,     // combo fired; keycode: the combo's keycode
+    TRACE_TAP_DANCE, // tap dance finished; keycode: TD(n), key: see `trace_tap_dance()`
+} trace_kind_t;
+
+typedef struct {
+    uint32_t time;    // µs, wraps after about 71 minutes
+    uint16_t keycode; // keycode at the time of the event
+    uint8_t  key;     // matrix position as row << 4 | col, 0xFF if the event has none
+    uint8_t  kind;    // trace_kind_t
+} trace_entry_t;
+
+// Called for every key event before combos and tap-hold see it.
+void trace_record(uint16_t keycode, keyrecord_t *record);
+
+// Called once the event has been resolved by tap-hold (from `process_record_kb`). Returns false
+// for `TRACE_DUMP`.
+bool trace_resolve(uint16_t keycode, keyrecord_t *record);
+
+#ifdef TAP_DANCE_ENABLE
+// Call from a tap dance's `finished` function. Records the tap count in the lower nibble of
+// `key`, bit 7 if the key is still held and bit 6 if the dance was interrupted.
+void trace_tap_dance(tap_dance_state_t *state);
+#endif
+
+// Prints the next few entries while a dump is in progress (from `housekeeping_task_kb`).
+void trace_task(void);
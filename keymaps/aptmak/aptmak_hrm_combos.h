@@ -17,8 +17,7 @@ enum custom_keycodes {
     SYM,
     FUN,
     KC_MDOT,
-    KC_SCH,
-    KC_DELLINE
+    KC_SCH
 };
 
 // LEFT HAND HOME ROW MODS
@@ -122,7 +121,7 @@ combo_t key_combos[] = {
     // deletion
     [BSPC_COMBO] = COMBO(bspc_combo, KC_BSPC),
     [DELW_COMBO] = COMBO(delw_combo, C(KC_BSPC)),
-    [DELLINE_COMBO] = COMBO(delline_combo, KC_DELLINE),
+    [DELLINE_COMBO] = COMBO(delline_combo, EDIT_DELETE_LINE),
     [DEL_COMBO] = COMBO(del_combo, KC_DEL),
 };
 
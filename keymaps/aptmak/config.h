@@ -16,3 +16,9 @@
 #undef LOCKING_SUPPORT_ENABLE
 #undef LOCKING_RESYNC_ENABLE
 #define NO_ACTION_ONESHOT
+
+// Delete line with Home/End (see features/edit_actions.h)
+#define EDIT_ACTIONS_HOST EDIT_HOST_LINUX
+
+// Start in NKRO mode, which SEND_STRING_PACKED needs (see features/packed_string.h)
+#define FORCE_NKRO
@@ -1,2 +1,5 @@
 COMBO_ENABLE = yes
 CAPS_WORD_ENABLE = yes
+PACKED_STRING_ENABLE = yes
+OVERRIDE_TABLE_ENABLE = yes
+EDIT_ACTIONS_ENABLE = yes
@@ -60,75 +60,21 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     )
 };
 
-//// custom shifted comma (->semicolon) and dot (->colon)
-// Initialize variable holding the binary
-// representation of active modifiers.
-uint8_t mod_state;
+// Custom shifted comma (->semicolon) and dot (->colon), see features/override_table.h:
+const override_table_entry_t PROGMEM override_table[] = {
+    CUSTOM_SHIFT(KC_COMMA, KC_SCLN),
+    CUSTOM_SHIFT(KC_DOT, KC_COLN),
+};
+const uint8_t override_table_count = ARRAY_SIZE(override_table);
+
 bool process_record_user(uint16_t keycode, keyrecord_t *record) {
-    // Store the current modifier state in the variable for later reference
-    mod_state = get_mods();
     switch (keycode) {
-        case KC_COMMA:
-        {
-            // Initialize a boolean variable that keeps track
-            // of the comma key status: registered or not?
-            static bool sclnkey_registered;
-            if (record->event.pressed) {
-                // Detect the activation of either shift keys
-                if (mod_state & MOD_MASK_SHIFT) {
-                    // First temporarily canceling both shifts so that
-                    // shift isn't applied to the KC_SCLN keycode
-                    del_mods(MOD_MASK_SHIFT);
-                    register_code(KC_SCLN);
-                    // Update the boolean variable to reflect the status of KC_SCLN
-                    sclnkey_registered = true;
-                    // Reapplying modifier state so that the held shift key(s)
-                    // still work even after having tapped the Backspace/Delete key.
-                    set_mods(mod_state);
-                    return false;
-                }
-            } else { // on release of KC_COMMA
-                // In case KC_SCLN is still being sent even after the release of KC_COMMA
-                if (sclnkey_registered) {
-                    unregister_code(KC_SCLN);
-                    sclnkey_registered = false;
-                    return false;
-                }
-            }
-            // Let QMK process the KC_COMMA keycode as usual outside of shift
-            return true;
-        }
-        case KC_DOT:
-        {
-            // Initialize a boolean variable that keeps track
-            // of the comma key status: registered or not?
-            static bool sclnkey_registered;
-            if (record->event.pressed) {
-                // Detect the activation of either shift keys
-                if (mod_state & MOD_MASK_SHIFT) {
-                    // send KC_SCLN instead (turns to colon due to shift)
-                    register_code(KC_SCLN);
-                    // Update the boolean variable to reflect the status of KC_SCLN
-                    sclnkey_registered = true;
-                    return false;
-                }
-            } else { // on release of KC_DOT
-                // In case KC_SCLN is still being sent even after the release of KC_DOT
-                if (sclnkey_registered) {
-                    unregister_code(KC_SCLN);
-                    sclnkey_registered = false;
-                    return false;
-                }
-            }
-            // Let QMK process the KC_DOT keycode as usual outside of shift
-            return true;
-        }
         case KC_SCH:
         {
             if (record->event.pressed) {
-                tap_code(KC_S);
-                tap_code(KC_C);
-                tap_code(KC_H);
+                macro_queue_tap(KC_S);
+                macro_queue_tap(KC_C);
+                macro_queue_tap(KC_H);
             } else {
             }
             break;
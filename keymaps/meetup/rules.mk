@@ -1,2 +1,4 @@
 COMBO_ENABLE = yes
 CAPS_WORD_ENABLE = yes
+MACRO_QUEUE_ENABLE = yes
+OVERRIDE_TABLE_ENABLE = yes
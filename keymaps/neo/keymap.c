@@ -320,11 +320,11 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         case MACRO_MENU_KEY:
             if (record->event.pressed) {
                 // I have mapped double tapping the CMD key to show the context menu in BetterTouchTool.
-                tap_code(KC_LGUI);
-                tap_code(KC_LGUI);
+                macro_queue_tap(KC_LGUI);
+                macro_queue_tap(KC_LGUI);
                 // Since not all apps seem to define a propper context menu, we try S(KC_F10) as
                 // well:
-                tap_code16(S(KC_F10));
+                macro_queue_tap(S(KC_F10));
             }
             break;
     }
@@ -346,6 +346,22 @@ bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
     }
 }
 
+// The single-finger CTRL and ALT mod-taps become a hold only if another key is pressed *and
+// released* while they are down (see features/release_hold.h):
+bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) {
+    switch (keycode) {
+        case PUQ_LP:
+        case PUQ_RP:
+        case PUQ_LA:
+        case PUQ_RA:
+        case PUQ_LB:
+        case PUQ_RB:
+            return get_release_hold(keycode, record);
+        default:
+            return false;
+    }
+}
+
 // Key Overrides:
 const key_override_t **key_overrides = (const key_override_t *[]){
     &shift_comma_is_dash,
@@ -9,6 +9,7 @@
 #define COMBO_MUST_HOLD_PER_COMBO
 
 #define TAPPING_TERM 200 // default: 200
+#define TAPPING_TERM_PER_KEY // shorter for the F-keys, see get_tapping_term()
 // #define RETRO_TAPPING
 
 #define PERMISSIVE_HOLD
@@ -16,3 +17,5 @@
 #define HOLD_ON_OTHER_KEY_PRESS
 #define HOLD_ON_OTHER_KEY_PRESS_PER_KEY
 
+#define LAYER_TAP_STREAK_TERM 150 // default: 150
+
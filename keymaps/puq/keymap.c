@@ -166,63 +166,59 @@ enum tapdances {
 };
 
 /*
- *  Tap-Dance functions.
+ *  Tap-Dances (see features/tap_dance_table.h).
  *
- *  These functions are required because MT and LT do not support key codes with modifiers.
- *  See https://docs.qmk.fm/#/feature_tap_dance?id=example-5
+ *  The first group is required because MT and LT do not support key codes with modifiers.
  */
 
-// Define a type containing as many tapdance states as you need
-typedef enum {
-    TD_NONE,
-    TD_UNKNOWN,
-    TD_SINGLE_TAP,
-    TD_SINGLE_HOLD,
-} td_state_t;
-
-// Create a global instance of the tapdance state type
-// (I use a single instance for all tap-dances, although I am no sure if this is correct in all
-// possible situations.)
-static td_state_t td_state;
-
-// Function to determine the current tapdance state
-td_state_t cur_dance(tap_dance_state_t *state);
-
-// `finished` and `reset` functions for each tapdance keycode
-void neo4_slash_finished(tap_dance_state_t *state, void *user_data);
-void neo4_slash_reset(tap_dance_state_t *state, void *user_data);
-void gui_left_brace_finished(tap_dance_state_t *state, void *user_data);
-void gui_left_brace_reset(tap_dance_state_t *state, void *user_data);
-void alt_right_brace_finished(tap_dance_state_t *state, void *user_data);
-void alt_right_brace_reset(tap_dance_state_t *state, void *user_data);
-void ctl_pipe_finished(tap_dance_state_t *state, void *user_data);
-void ctl_pipe_reset(tap_dance_state_t *state, void *user_data);
-void alt_left_paren_finished(tap_dance_state_t *state, void *user_data);
-void alt_left_paren_reset(tap_dance_state_t *state, void *user_data);
-void gui_right_paren_finished(tap_dance_state_t *state, void *user_data);
-void gui_right_paren_reset(tap_dance_state_t *state, void *user_data);
-void ctl_double_quote_finished(tap_dance_state_t *state, void *user_data);
-void ctl_double_quote_reset(tap_dance_state_t *state, void *user_data);
+const tap_dance_table_entry_t PROGMEM tap_dance_table[] = {
+    //                         tap              hold        double tap
+    [TD_LT_NEO4_SLASH]       = {DE_SLASH,        MO(NEO4),   KC_NO},
+    [TD_MT_GUI_LEFT_BRACE]   = {DE_LEFT_BRACE,   KC_LGUI,    KC_NO},
+    [TD_MT_ALT_RIGHT_BRACE]  = {DE_RIGHT_BRACE,  KC_LALT,    KC_NO},
+    [TD_MT_CTL_PIPE]         = {DE_PIPE,         KC_LCTL,    KC_NO},
+    [TD_MT_ALT_LEFT_PAREN]   = {DE_LEFT_PAREN,   KC_LALT,    KC_NO},
+    [TD_MT_GUI_RIGHT_PAREN]  = {DE_RIGHT_PAREN,  KC_LGUI,    KC_NO},
+    [TD_MT_CTL_DOUBLE_QUOTE] = {DE_DOUBLE_QUOTE, KC_LCTL,    KC_NO},
+    [TD_F01_F11]             = {KC_F1,           KC_NO,      KC_F11},
+    [TD_F02_F12]             = {KC_F2,           KC_NO,      KC_F12},
+    [TD_F03_F13]             = {KC_F3,           KC_NO,      KC_F13},
+    [TD_F04_F14]             = {KC_F4,           KC_NO,      KC_F14},
+    [TD_F05_F15]             = {KC_F5,           KC_NO,      KC_F15},
+    [TD_F06_F16]             = {KC_F6,           KC_NO,      KC_F16},
+    [TD_F07_F17]             = {KC_F7,           KC_NO,      KC_F17},
+    [TD_F08_F18]             = {KC_F8,           KC_NO,      KC_F18},
+    [TD_F09_F19]             = {KC_F9,           KC_NO,      KC_F19},
+};
 
 tap_dance_action_t tap_dance_actions[] = {
-    [TD_LT_NEO4_SLASH]        = ACTION_TAP_DANCE_FN_ADVANCED(NULL, neo4_slash_finished, neo4_slash_reset),
-    [TD_MT_GUI_LEFT_BRACE]    = ACTION_TAP_DANCE_FN_ADVANCED(NULL, gui_left_brace_finished, gui_left_brace_reset),
-    [TD_MT_ALT_RIGHT_BRACE]   = ACTION_TAP_DANCE_FN_ADVANCED(NULL, alt_right_brace_finished, alt_right_brace_reset),
-    [TD_MT_CTL_PIPE]          = ACTION_TAP_DANCE_FN_ADVANCED(NULL, ctl_pipe_finished, ctl_pipe_reset),
-    [TD_MT_ALT_LEFT_PAREN]    = ACTION_TAP_DANCE_FN_ADVANCED(NULL, alt_left_paren_finished, alt_left_paren_reset),
-    [TD_MT_GUI_RIGHT_PAREN]   = ACTION_TAP_DANCE_FN_ADVANCED(NULL, gui_right_paren_finished, gui_right_paren_reset),
-    [TD_MT_CTL_DOUBLE_QUOTE] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, ctl_double_quote_finished, ctl_double_quote_reset),
-    [TD_F01_F11] = ACTION_TAP_DANCE_DOUBLE(KC_F1, KC_F11),
-    [TD_F02_F12] = ACTION_TAP_DANCE_DOUBLE(KC_F2, KC_F12),
-    [TD_F03_F13] = ACTION_TAP_DANCE_DOUBLE(KC_F3, KC_F13),
-    [TD_F04_F14] = ACTION_TAP_DANCE_DOUBLE(KC_F4, KC_F14),
-    [TD_F05_F15] = ACTION_TAP_DANCE_DOUBLE(KC_F5, KC_F15),
-    [TD_F06_F16] = ACTION_TAP_DANCE_DOUBLE(KC_F6, KC_F16),
-    [TD_F07_F17] = ACTION_TAP_DANCE_DOUBLE(KC_F7, KC_F17),
-    [TD_F08_F18] = ACTION_TAP_DANCE_DOUBLE(KC_F8, KC_F18),
-    [TD_F09_F19] = ACTION_TAP_DANCE_DOUBLE(KC_F9, KC_F19),
+    [TD_LT_NEO4_SLASH]       = ACTION_TAP_DANCE_TABLE(TD_LT_NEO4_SLASH),
+    [TD_MT_GUI_LEFT_BRACE]   = ACTION_TAP_DANCE_TABLE(TD_MT_GUI_LEFT_BRACE),
+    [TD_MT_ALT_RIGHT_BRACE]  = ACTION_TAP_DANCE_TABLE(TD_MT_ALT_RIGHT_BRACE),
+    [TD_MT_CTL_PIPE]         = ACTION_TAP_DANCE_TABLE(TD_MT_CTL_PIPE),
+    [TD_MT_ALT_LEFT_PAREN]   = ACTION_TAP_DANCE_TABLE(TD_MT_ALT_LEFT_PAREN),
+    [TD_MT_GUI_RIGHT_PAREN]  = ACTION_TAP_DANCE_TABLE(TD_MT_GUI_RIGHT_PAREN),
+    [TD_MT_CTL_DOUBLE_QUOTE] = ACTION_TAP_DANCE_TABLE(TD_MT_CTL_DOUBLE_QUOTE),
+    [TD_F01_F11]             = ACTION_TAP_DANCE_TABLE(TD_F01_F11),
+    [TD_F02_F12]             = ACTION_TAP_DANCE_TABLE(TD_F02_F12),
+    [TD_F03_F13]             = ACTION_TAP_DANCE_TABLE(TD_F03_F13),
+    [TD_F04_F14]             = ACTION_TAP_DANCE_TABLE(TD_F04_F14),
+    [TD_F05_F15]             = ACTION_TAP_DANCE_TABLE(TD_F05_F15),
+    [TD_F06_F16]             = ACTION_TAP_DANCE_TABLE(TD_F06_F16),
+    [TD_F07_F17]             = ACTION_TAP_DANCE_TABLE(TD_F07_F17),
+    [TD_F08_F18]             = ACTION_TAP_DANCE_TABLE(TD_F08_F18),
+    [TD_F09_F19]             = ACTION_TAP_DANCE_TABLE(TD_F09_F19),
 };
 
+// F1…F9 cannot be sent before it is known that no second tap follows (which would mean F11…F19).
+// A double tap of the same finger is quick, so they wait for it for less than the tapping term:
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    if (keycode >= TD(TD_F01_F11) && keycode <= TD(TD_F09_F19)) {
+        return 150;
+    }
+    return TAPPING_TERM;
+}
+
 /* naming scheme for #defines:
        ┌────┬────┬────┐                     ┌────┬────┬────┐
        │ L7 │ L8 │ L9 ├────┐           ┌────┤ R7 │ R8 │ R9 │
@@ -250,6 +246,11 @@ tap_dance_action_t tap_dance_actions[] = {
        f: Layer FUNC
    - `*` indicates that a key override exists
    - `"…` indicates the compose key. Used to type German umlautes (and other stuff).
+   - Umlauts and ß are also available as combos of two vertically adjacent keys, which saves the
+     compose round trip: Ä = .+E, Ö = Q+O, Ü = E+"…, ß = L+R
+   - W+R repeats the last key (e.g. for "ff", with F being a combo itself), G+D and ,+"… are
+     the magic key for the other hand (e.g. "t" after "g" with ,+"…, "-" after "," with G+D, see
+     `magic_key_table`)
 
        ┌────┬────┬────┐                     ┌────┬────┬────┐
        │  M │  L │  C ├─────┐         ┌─────┤  ,*│ "… │  U │
@@ -434,11 +435,11 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         case MY_MENU:
             if (record->event.pressed) {
                 // I have mapped double tapping the CMD key to show the context menu in BetterTouchTool.
-                tap_code(KC_LGUI);
-                tap_code(KC_LGUI);
+                macro_queue_tap(KC_LGUI);
+                macro_queue_tap(KC_LGUI);
                 // Since not all apps seem to define a propper context menu, we try S(KC_F10) as
                 // well:
-                tap_code16(S(KC_F10));
+                macro_queue_tap(S(KC_F10));
             }
             break;
     }
@@ -472,22 +473,54 @@ bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
     return result;
 }
 
+// Shift is harmless on its own, so the thumb shifts send it right away instead of waiting for the
+// tap-hold decision. A tap withdraws it again before sending Space (see features/speculative_hold.h).
+bool get_speculative_hold(uint16_t keycode, keyrecord_t *record) {
+    switch (keycode) {
+        case PUQ_LS: // same keycode as PUQ_RS
+            return true;
+        default:
+            return false;
+    }
+}
+
+// N and I (NEO4) and Esc (FUNC) are typed right after letters all the time, e.g. in "in" or
+// "ni". Within a word they send their tap at once (see features/layer_tap_streak.h). The NEO3
+// pinky keys are left out, since symbols follow letters on purpose.
+uint16_t get_layer_tap_streak_term(uint16_t keycode, keyrecord_t *record) {
+    switch (keycode) {
+        case PUQ_L4:
+        case PUQ_R6:
+        case PUQ_LE:
+            return LAYER_TAP_STREAK_TERM;
+        default:
+            return 0;
+    }
+}
+
 // Combos:
 const uint16_t PROGMEM puq_l1_l4[] = {PUQ_L1, PUQ_L4, COMBO_END};
+const uint16_t PROGMEM puq_l2_l5[] = {PUQ_L2, PUQ_L5, COMBO_END};
 const uint16_t PROGMEM puq_l3_l6[] = {PUQ_L3, PUQ_L6, COMBO_END};
 const uint16_t PROGMEM puq_l4_l5[] = {PUQ_L4, PUQ_L5, COMBO_END};
 const uint16_t PROGMEM puq_l4_l6[] = {PUQ_L5, PUQ_L6, COMBO_END};
 const uint16_t PROGMEM puq_l4_l7[] = {PUQ_L4, PUQ_L7, COMBO_END};
+const uint16_t PROGMEM puq_l5_l8[] = {PUQ_L5, PUQ_L8, COMBO_END};
 const uint16_t PROGMEM puq_l6_l9[] = {PUQ_L6, PUQ_L9, COMBO_END};
+const uint16_t PROGMEM puq_la_lb[] = {PUQ_LA, PUQ_LB, COMBO_END};
 const uint16_t PROGMEM puq_r1_r4[] = {PUQ_R1, PUQ_R4, COMBO_END};
 const uint16_t PROGMEM puq_r1_r2[] = {PUQ_R1, PUQ_R2, COMBO_END};
 const uint16_t PROGMEM puq_r2_r3[] = {PUQ_R2, PUQ_R3, COMBO_END};
+const uint16_t PROGMEM puq_r2_r5[] = {PUQ_R2, PUQ_R5, COMBO_END};
 const uint16_t PROGMEM puq_r3_r6[] = {PUQ_R3, PUQ_R6, COMBO_END};
 const uint16_t PROGMEM puq_r4_r5[] = {PUQ_R4, PUQ_R5, COMBO_END};
 const uint16_t PROGMEM puq_r4_r6[] = {PUQ_R4, PUQ_R6, COMBO_END};
 const uint16_t PROGMEM puq_r4_r7[] = {PUQ_R4, PUQ_R7, COMBO_END};
 const uint16_t PROGMEM puq_r5_r6[] = {PUQ_R5, PUQ_R6, COMBO_END};
+const uint16_t PROGMEM puq_r5_r8[] = {PUQ_R5, PUQ_R8, COMBO_END};
 const uint16_t PROGMEM puq_r6_r9[] = {PUQ_R6, PUQ_R9, COMBO_END};
+const uint16_t PROGMEM puq_r7_r8[] = {PUQ_R7, PUQ_R8, COMBO_END};
+const uint16_t PROGMEM puq_ra_rb[] = {PUQ_RA, PUQ_RB, COMBO_END};
 
 const uint16_t PROGMEM neo3_l1_l4[] = {NEO3_L1, NEO3_L4, COMBO_END};
 const uint16_t PROGMEM neo3_l3_l6[] = {NEO3_L3, NEO3_L6, COMBO_END};
@@ -523,6 +556,18 @@ combo_t key_combos[] = {
 
     COMBO(neo4_l4_l7, KC_PAGE_UP),
 
+    // German characters, each a single key of the "German (no dead keys)" layout, so they need
+    // neither the compose key nor a second keystroke:
+    COMBO(puq_r2_r5, DE_AUML),
+    COMBO(puq_ra_rb, DE_OUML),
+    COMBO(puq_r5_r8, DE_UUML),
+    COMBO(puq_l5_l8, DE_SZLIG),
+
+    // Repeat Key and magic key (the Alternate Repeat Key):
+    COMBO(puq_l2_l5, QK_REP),
+    COMBO(puq_la_lb, QK_AREP),
+    COMBO(puq_r7_r8, QK_AREP),
+
     // BACKSPACE & DELETE on (almost) all layers:
     COMBO(puq_r1_r2, KC_BACKSPACE),
     COMBO(puq_r2_r3, KC_DELETE),
@@ -580,27 +625,38 @@ bool get_combo_must_tap(uint16_t _index, combo_t *combo) {
 */
 }
 
-// Key Overrides:
-const key_override_t shift_comma_is_dash = ko_make_with_layers_and_negmods(
-        MOD_MASK_SHIFT,
-        PUQ_R7,
-        DE_DASH,
-        PUQ_MASK, // only on PUQ layer
-        MOD_MASK_CAG // not when combined with any other modifier
-      );
-const key_override_t shift_dot_is_bullet = ko_make_with_layers_and_negmods(
-        MOD_MASK_SHIFT,
-        PUQ_R2,
-        DE_BULLET,
-        PUQ_MASK, // only on PUQ layer
-        MOD_MASK_CAG // not when combined with any other modifier
-      );
-
-const key_override_t **key_overrides = (const key_override_t *[]){
-    &shift_comma_is_dash,
-    &shift_dot_is_bullet,
-    NULL // terminator
+// Magic key (the Alternate Repeat Key, see features/magic_key.h): the key that follows the last
+// one. Same-finger bigrams of German words become the last key and the magic key of the other
+// hand: ,+"… after a left-hand key (e.g. "gt", "nz"), G+D after a right-hand key (e.g. "ik"). The
+// other entries close what was opened. The table must be sorted by the previous keycode.
+const magic_key_entry_t PROGMEM magic_key_table[] = {
+    // previous       next
+    {DE_D,            DE_T},             // Stadt
+    {DE_G,            DE_T},             // sagt
+    {DE_I,            DE_K},             // Musik
+    {DE_N,            DE_Z},             // ganz
+    {DE_P,            DE_T},             // Haupt
+    {DE_COMMA,        DE_MINUS},
+    {DE_LESS_THAN,    DE_GREATER_THAN},
+    {DE_DOUBLE_QUOTE, DE_DOUBLE_QUOTE},
+    {DE_LEFT_PAREN,   DE_RIGHT_PAREN},
+    {DE_LEFT_BRACKET, DE_RIGHT_BRACKET},
+    {DE_LEFT_BRACE,   DE_RIGHT_BRACE},
+};
+const uint8_t magic_key_table_count = ARRAY_SIZE(magic_key_table);
+
+uint16_t get_alt_repeat_key_keycode_user(uint16_t keycode, uint8_t mods) {
+    return magic_key_lookup(keycode, mods);
+}
+
+// Key Overrides (see features/override_table.h), only on the PUQ layer and not when combined with
+// any other modifier:
+const override_table_entry_t PROGMEM override_table[] = {
+    // trigger  trigger mods    replacement  layers    negative mods
+    {PUQ_R7,    MOD_MASK_SHIFT, DE_DASH,     PUQ_MASK, MOD_MASK_CAG},
+    {PUQ_R2,    MOD_MASK_SHIFT, DE_BULLET,   PUQ_MASK, MOD_MASK_CAG},
 };
+const uint8_t override_table_count = ARRAY_SIZE(override_table);
 
 // Keymaps (not much info here):
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
@@ -632,135 +688,3 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
                                      FUNC_LS, FUNC_LE,  FUNC_RE, FUNC_RS
     )
 };
-
-/*
- * Implementations of tap-dance functions:
- */
-
-// Determine the tapdance state to return
-td_state_t cur_dance(tap_dance_state_t *state) {
-    if (state->count == 1) {
-        if (state->interrupted || !state->pressed) return TD_SINGLE_TAP;
-        else return TD_SINGLE_HOLD;
-    }
-    return TD_UNKNOWN;
-}
-
-void neo4_slash_finished(tap_dance_state_t *state, void *user_data) {
-    td_state = cur_dance(state);
-    switch (td_state) {
-        case TD_SINGLE_TAP: register_code16(DE_SLASH); break;
-        case TD_SINGLE_HOLD: layer_on(NEO4); break;
-        default: break;
-    }
-}
-
-void neo4_slash_reset(tap_dance_state_t *state, void *user_data) {
-    switch (td_state) {
-        case TD_SINGLE_TAP: unregister_code16(DE_SLASH); break;
-        case TD_SINGLE_HOLD: layer_off(NEO4); break;
-        default: break;
-    }
-}
-
-void gui_left_brace_finished(tap_dance_state_t *state, void *user_data) {
-    td_state = cur_dance(state);
-    switch (td_state) {
-        case TD_SINGLE_TAP: register_code16(DE_LEFT_BRACE); break;
-        case TD_SINGLE_HOLD: register_mods(MOD_BIT(KC_LGUI)); break;
-        default: break;
-    }
-}
-
-void gui_left_brace_reset(tap_dance_state_t *state, void *user_data) {
-    switch (td_state) {
-        case TD_SINGLE_TAP: unregister_code16(DE_LEFT_BRACE); break;
-        case TD_SINGLE_HOLD: unregister_mods(MOD_BIT(KC_LGUI)); break;
-        default: break;
-    }
-}
-
-void alt_right_brace_finished(tap_dance_state_t *state, void *user_data) {
-    td_state = cur_dance(state);
-    switch (td_state) {
-        case TD_SINGLE_TAP: register_code16(DE_RIGHT_BRACE); break;
-        case TD_SINGLE_HOLD: register_mods(MOD_BIT(KC_LALT)); break;
-        default: break;
-    }
-}
-
-void alt_right_brace_reset(tap_dance_state_t *state, void *user_data) {
-    switch (td_state) {
-        case TD_SINGLE_TAP: unregister_code16(DE_RIGHT_BRACE); break;
-        case TD_SINGLE_HOLD: unregister_mods(MOD_BIT(KC_LALT)); break;
-        default: break;
-    }
-}
-
-void ctl_pipe_finished(tap_dance_state_t *state, void *user_data) {
-    td_state = cur_dance(state);
-    switch (td_state) {
-        case TD_SINGLE_TAP: register_code16(DE_PIPE); break;
-        case TD_SINGLE_HOLD: register_mods(MOD_BIT(KC_LCTL)); break;
-        default: break;
-    }
-}
-
-void ctl_pipe_reset(tap_dance_state_t *state, void *user_data) {
-    switch (td_state) {
-        case TD_SINGLE_TAP: unregister_code16(DE_PIPE); break;
-        case TD_SINGLE_HOLD: unregister_mods(MOD_BIT(KC_LCTL)); break;
-        default: break;
-    }
-}
-
-void alt_left_paren_finished(tap_dance_state_t *state, void *user_data) {
-    td_state = cur_dance(state);
-    switch (td_state) {
-        case TD_SINGLE_TAP: register_code16(DE_LEFT_PAREN); break;
-        case TD_SINGLE_HOLD: register_mods(MOD_BIT(KC_LALT)); break;
-        default: break;
-    }
-}
-
-void alt_left_paren_reset(tap_dance_state_t *state, void *user_data) {
-    switch (td_state) {
-        case TD_SINGLE_TAP: unregister_code16(DE_LEFT_PAREN); break;
-        case TD_SINGLE_HOLD: unregister_mods(MOD_BIT(KC_LALT)); break;
-        default: break;
-    }
-}
-
-void gui_right_paren_finished(tap_dance_state_t *state, void *user_data) {
-    td_state = cur_dance(state);
-    switch (td_state) {
-        case TD_SINGLE_TAP: register_code16(DE_RIGHT_PAREN); break;
-        case TD_SINGLE_HOLD: register_mods(MOD_BIT(KC_LGUI)); break;
-        default: break;
-    }
-}
-
-void gui_right_paren_reset(tap_dance_state_t *state, void *user_data) {
-    switch (td_state) {
-        case TD_SINGLE_TAP: unregister_code16(DE_RIGHT_PAREN); break;
-        case TD_SINGLE_HOLD: unregister_mods(MOD_BIT(KC_LGUI)); break;
-        default: break;
-    }
-}
-
-void ctl_double_quote_finished(tap_dance_state_t *state, void *user_data) {
-    td_state = cur_dance(state);
-    switch (td_state) {
-        case TD_SINGLE_TAP: register_code16(DE_DOUBLE_QUOTE); break;
-        case TD_SINGLE_HOLD: register_mods(MOD_BIT(KC_LCTL)); break;
-        default: break;
-    }
-}
-
-void ctl_double_quote_reset(tap_dance_state_t *state, void *user_data) {
-    switch (td_state) {
-        case TD_SINGLE_TAP: unregister_code16(DE_DOUBLE_QUOTE); break;
-        case TD_SINGLE_HOLD: unregister_mods(MOD_BIT(KC_LCTL)); break;
-        default: break;
-    }
-}
@@ -2,6 +2,13 @@ CAPS_WORD_ENABLE = yes
 COMBO_ENABLE = yes
 CONSOLE_ENABLE = yes
 EXTRAKEY_ENABLE = yes
-KEY_OVERRIDE_ENABLE = yes
+LAYER_TAP_STREAK_ENABLE = yes
+MACRO_QUEUE_ENABLE = yes
+MAGIC_KEY_ENABLE = yes
 MOUSEKEY_ENABLE = yes
+OVERRIDE_TABLE_ENABLE = yes
+REPEAT_KEY_ENABLE = yes
+SPECULATIVE_HOLD_ENABLE = yes
 TAP_DANCE_ENABLE = yes
+TAP_DANCE_TABLE_ENABLE = yes
+# TRACE_ENABLE = yes # requires CONSOLE_ENABLE
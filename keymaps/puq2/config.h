@@ -7,5 +7,8 @@
 // #define TAPPING_TOGGLE 2 // require only two taps (default=5) to toggle layer
 
 // #define PERMISSIVE_HOLD
+#define PERMISSIVE_HOLD_PER_KEY // release-order resolution, see get_permissive_hold()
 #define HOLD_ON_OTHER_KEY_PRESS
 #define HOLD_ON_OTHER_KEY_PRESS_PER_KEY
+
+#define RELEASE_HOLD_MIN_OVERLAP 40 // default: 30
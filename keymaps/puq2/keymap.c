@@ -130,21 +130,6 @@ DEF_COMBO(PUQ, 13, R7, R8);
 DEF_COMBO(PUQ, 14, R8, R9);
 #define COMBO_PUQ_14_ACTION DE_DOT
 
-const key_override_t shift_comma_is_dash = ko_make_with_layers_and_negmods(
-        MOD_MASK_SHIFT,
-        DE_COMM,
-        DE_NDSH,
-        PUQ_MASK, // only on PUQ layer
-        MOD_MASK_CAG // not when combined with any other modifier
-      );
-const key_override_t shift_dot_is_bullet = ko_make_with_layers_and_negmods(
-        MOD_MASK_SHIFT,
-        DE_DOT,
-        DE_BULT,
-        PUQ_MASK, // only on PUQ layer
-        MOD_MASK_CAG // not when combined with any other modifier
-      );
-
 /* Layer SYM:
           ┌───────┬───────┬───────┐                           ┌───────┬───────┬───────┐
           │   ○┈┈ … ┈┈◑┈┈ ⌦ ┈┈●   │                           │   ●┈┈ ⌫ ┈┈●   │       │
@@ -322,11 +307,11 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         case MACRO_MENU_KEY:
             if (record->event.pressed) {
                 // I have mapped double tapping the CMD key to show the context menu in BetterTouchTool.
-                tap_code(KC_LGUI);
-                tap_code(KC_LGUI);
+                macro_queue_tap(KC_LGUI);
+                macro_queue_tap(KC_LGUI);
                 // Since not all apps seem to define a propper context menu, we try S(KC_F10) as
                 // well:
-                tap_code16(S(KC_F10));
+                macro_queue_tap(S(KC_F10));
             }
             break;
     }
@@ -348,12 +333,30 @@ bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
     }
 }
 
-// Key Overrides:
-const key_override_t **key_overrides = (const key_override_t *[]){
-    &shift_comma_is_dash,
-    &shift_dot_is_bullet,
-    NULL // terminator
+// The single-finger CTRL and ALT mod-taps become a hold only if another key is pressed *and
+// released* while they are down (see features/release_hold.h):
+bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) {
+    switch (keycode) {
+        case PUQ_LP:
+        case PUQ_RP:
+        case PUQ_LA:
+        case PUQ_RA:
+        case PUQ_LB:
+        case PUQ_RB:
+            return get_release_hold(keycode, record);
+        default:
+            return false;
+    }
+}
+
+// Key Overrides (see features/override_table.h), only on the PUQ layer and not when combined with
+// any other modifier:
+const override_table_entry_t PROGMEM override_table[] = {
+    // trigger  trigger mods    replacement  layers    negative mods
+    {DE_COMM,   MOD_MASK_SHIFT, DE_NDSH,     PUQ_MASK, MOD_MASK_CAG},
+    {DE_DOT,    MOD_MASK_SHIFT, DE_BULT,     PUQ_MASK, MOD_MASK_CAG},
 };
+const uint8_t override_table_count = ARRAY_SIZE(override_table);
 
 // Keymaps (not much info here):
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
@@ -1,8 +1,11 @@
 COMBO_ENABLE = yes
 EXTRAKEY_ENABLE = yes # required for media keys
-KEY_OVERRIDE_ENABLE = yes
+OVERRIDE_TABLE_ENABLE = yes
+MACRO_QUEUE_ENABLE = yes
 MOUSEKEY_ENABLE = yes
 NKRO_ENABLE = yes
+RELEASE_HOLD_ENABLE = yes
 # CAPS_WORD_ENABLE = yes
 # CONSOLE_ENABLE = yes
 # TAP_DANCE_ENABLE = yes
+# TRACE_ENABLE = yes # requires CONSOLE_ENABLE
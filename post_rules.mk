@@ -0,0 +1,77 @@
+# Keyboard-level feature modules (see features/). They are enabled from a keymap's rules.mk, which
+# is processed before this file.
+
+# The per-key state is shared by the features that track key events:
+ifneq ($(filter yes,$(strip $(RELEASE_HOLD_ENABLE)) $(strip $(LAYER_TAP_STREAK_ENABLE))),)
+    KEY_STATE_ENABLE = yes
+endif
+
+# The editing actions are sent through the macro queue:
+ifeq ($(strip $(EDIT_ACTIONS_ENABLE)), yes)
+    MACRO_QUEUE_ENABLE = yes
+endif
+
+ifeq ($(strip $(KEY_STATE_ENABLE)), yes)
+    OPT_DEFS += -DKEY_STATE_ENABLE
+    SRC += features/key_state.c
+endif
+
+ifeq ($(strip $(RELEASE_HOLD_ENABLE)), yes)
+    OPT_DEFS += -DRELEASE_HOLD_ENABLE
+    SRC += features/release_hold.c
+endif
+
+ifeq ($(strip $(SPECULATIVE_HOLD_ENABLE)), yes)
+    OPT_DEFS += -DSPECULATIVE_HOLD_ENABLE
+    SRC += features/speculative_hold.c
+endif
+
+ifeq ($(strip $(TRACE_ENABLE)), yes)
+    OPT_DEFS += -DTRACE_ENABLE
+    SRC += features/trace.c
+endif
+
+ifeq ($(strip $(KEYLOG_ENABLE)), yes)
+    OPT_DEFS += -DKEYLOG_ENABLE
+    SRC += features/keylog.c
+endif
+
+ifeq ($(strip $(LATENCY_PROBE_ENABLE)), yes)
+    OPT_DEFS += -DLATENCY_PROBE_ENABLE
+    SRC += features/latency_probe.c
+endif
+
+ifeq ($(strip $(LAYER_TAP_STREAK_ENABLE)), yes)
+    OPT_DEFS += -DLAYER_TAP_STREAK_ENABLE
+    SRC += features/layer_tap_streak.c
+endif
+
+ifeq ($(strip $(TAP_DANCE_TABLE_ENABLE)), yes)
+    OPT_DEFS += -DTAP_DANCE_TABLE_ENABLE
+    SRC += features/tap_dance_table.c
+endif
+
+ifeq ($(strip $(OVERRIDE_TABLE_ENABLE)), yes)
+    OPT_DEFS += -DOVERRIDE_TABLE_ENABLE
+    SRC += features/override_table.c
+endif
+
+ifeq ($(strip $(MACRO_QUEUE_ENABLE)), yes)
+    OPT_DEFS += -DMACRO_QUEUE_ENABLE
+    SRC += features/macro_queue.c
+endif
+
+ifeq ($(strip $(PACKED_STRING_ENABLE)), yes)
+    OPT_DEFS += -DPACKED_STRING_ENABLE
+    SRC += features/packed_string.c
+endif
+
+ifeq ($(strip $(EDIT_ACTIONS_ENABLE)), yes)
+    OPT_DEFS += -DEDIT_ACTIONS_ENABLE
+    SRC += features/edit_actions.c
+endif
+
+ifeq ($(strip $(MAGIC_KEY_ENABLE)), yes)
+    OPT_DEFS += -DMAGIC_KEY_ENABLE
+    SRC += features/magic_key.c
+endif
@@ -0,0 +1,909 @@
+// Evaluates a layout on a text corpus: every character is mapped back to the presses that type it
+// with the keymap, and the presses are counted per finger and per pair of characters.
+//
+//   build/puq/corpus [options] [file...]
+//
+// The reverse map is not parsed from the keymap's source: each candidate stroke (a tap, a combo,
+// held keys with a tap or a combo, a tap after a tap for one-shot keys) is run through the model,
+// so combos, key overrides and tap dances resolve exactly as on the keyboard. A stroke types a
+// character if the host receives exactly one key, which the host layout (`--host`) turns into the
+// character. The cheapest stroke (fewest presses) is kept for each character.
+//
+// The corpus is read as UTF-8 in chunks by several threads, so memory use does not depend on its
+// size. Characters are counted individually, so a modifier held over several characters (e.g.
+// shift for a word in capitals) is counted as pressed for each of them.
+//
+// `--check` verifies the host layout instead: the strokes of the characters go as HID reports
+// through a virtual keyboard of the Linux kernel (uhid) to the layout of an actual desktop (XKB).
+// It needs libxkbcommon when the tools are built and access to /dev/uhid.
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+#ifdef XKB_ENABLE
+#    include <fcntl.h>
+#    include <glob.h>
+#    include <limits.h>
+#    include <linux/input.h>
+#    include <linux/uhid.h>
+#    include <sys/ioctl.h>
+#    include <xkbcommon/xkbcommon.h>
+#endif
+
+#ifndef SIM_HOST_LAYOUT
+#    define SIM_HOST_LAYOUT "us"
+#endif
+
+#define START_TIME 100000   // µs, the keyboard has been running for a while
+#define SETTLE_TIME 1000000 // µs after the last event, so that every pending decision times out
+#define CHUNK_SIZE (1 << 20)
+#define MAX_PRESSES 6
+#define MAX_STROKES 256
+#define MAX_THREADS 64
+#define CP_LIMIT 0x2200 // characters up to U+21FF are evaluated, e.g. – and …
+#define OTHER CP_LIMIT  // counter for all other characters
+
+typedef enum { PRESS_HOLD, PRESS_TAP, PRESS_CHORD } press_kind_t;
+
+typedef struct {
+    uint8_t      row, col;
+    press_kind_t kind; // consecutive PRESS_CHORDs are pressed together
+} press_t;
+
+typedef struct {
+    press_t  presses[MAX_PRESSES];
+    uint8_t  count;
+    uint32_t character;
+    uint8_t  hand;  // of the last press: 0 left, 1 right
+    bool     chord; // needs a combo
+} stroke_t;
+
+typedef enum { L_PINKY, L_RING, L_MIDDLE, L_INDEX, L_THUMB, R_THUMB, R_INDEX, R_MIDDLE, R_RING, R_PINKY, FINGER_COUNT } finger_t;
+
+static const char *finger_names[] = {"L pinky", "L ring", "L middle", "L index", "L thumb", "R thumb", "R index", "R middle", "R ring", "R pinky"};
+
+// Fingers of the matrix positions (see the naming scheme in the keymaps):
+static const finger_t fingers[MATRIX_ROWS][MATRIX_COLS] = {
+    {L_RING, L_MIDDLE, L_INDEX, L_INDEX},  // L7 L8 L9 LA
+    {L_RING, L_MIDDLE, L_INDEX, L_INDEX},  // L4 L5 L6 LB
+    {L_PINKY, L_RING, L_MIDDLE, L_INDEX},  // LP L1 L2 L3
+    {R_THUMB, L_THUMB, R_THUMB, L_THUMB},  // RS LS RE LE
+    {R_PINKY, R_RING, R_MIDDLE, R_INDEX},  // RP R3 R2 R1
+    {R_RING, R_MIDDLE, R_INDEX, R_INDEX},  // R6 R5 R4 RB
+    {R_RING, R_MIDDLE, R_INDEX, R_INDEX},  // R9 R8 R7 RA
+};
+
+static stroke_t strokes[MAX_STROKES];
+static uint16_t stroke_count;
+static int16_t  stroke_of[CP_LIMIT]; // index into strokes, -1 if the character cannot be typed
+
+/*
+ * Host layouts: the characters of a HID usage without modifiers, with shift, with alt (AltGr or
+ * Option) and with both. Dead keys and characters outside CP_LIMIT are left out.
+ */
+
+typedef const char *host_layout_t[256][4];
+
+static const host_layout_t us_layout = {
+    [KC_1] = {"1", "!"}, [KC_2] = {"2", "@"}, [KC_3] = {"3", "#"}, [KC_4] = {"4", "$"}, [KC_5] = {"5", "%"},
+    [KC_6] = {"6", "^"}, [KC_7] = {"7", "&"}, [KC_8] = {"8", "*"}, [KC_9] = {"9", "("}, [KC_0] = {"0", ")"},
+    [KC_ENTER] = {"\n"}, [KC_TAB] = {"\t"}, [KC_SPACE] = {" ", " "},
+    [KC_MINUS] = {"-", "_"}, [KC_EQUAL] = {"=", "+"}, [KC_LEFT_BRACKET] = {"[", "{"}, [KC_RIGHT_BRACKET] = {"]", "}"},
+    [KC_BACKSLASH] = {"\\", "|"}, [KC_NONUS_HASH] = {"\\", "|"}, [KC_SEMICOLON] = {";", ":"}, [KC_QUOTE] = {"'", "\""},
+    [KC_GRAVE] = {"`", "~"}, [KC_COMMA] = {",", "<"}, [KC_DOT] = {".", ">"}, [KC_SLASH] = {"/", "?"},
+};
+
+// German (Mac, ISO) as in sim/include/keymap_german_mac_iso.h, with y and z swapped below:
+static const host_layout_t de_layout = {
+    [KC_1] = {"1", "!"}, [KC_2] = {"2", "\""}, [KC_3] = {"3", "§"}, [KC_4] = {"4", "$"}, [KC_5] = {"5", "%", "["},
+    [KC_6] = {"6", "&", "]"}, [KC_7] = {"7", "/", "|", "\\"}, [KC_8] = {"8", "(", "{"}, [KC_9] = {"9", ")", "}"}, [KC_0] = {"0", "="},
+    [KC_ENTER] = {"\n"}, [KC_TAB] = {"\t"}, [KC_SPACE] = {" ", " "},
+    [KC_MINUS] = {"ß", "?"}, [KC_LEFT_BRACKET] = {"ü", "Ü", "•"}, [KC_RIGHT_BRACKET] = {"+", "*"},
+    [KC_BACKSLASH] = {"#", "'"}, [KC_NONUS_HASH] = {"#", "'"}, [KC_SEMICOLON] = {"ö", "Ö"}, [KC_QUOTE] = {"ä", "Ä"},
+    [KC_NONUS_BACKSLASH] = {"^", "°"}, [KC_GRAVE] = {"<", ">"}, [KC_COMMA] = {",", ";"}, [KC_DOT] = {".", ":", "…"},
+    [KC_SLASH] = {"-", "_", "–"}, [KC_L] = {"l", "L", "@"}, [KC_N] = {"n", "N", "~"},
+};
+
+static const host_layout_t *host_layout;
+
+static uint32_t decode(const uint8_t **text, const uint8_t *end) {
+    const uint8_t *p = *text;
+    uint8_t        length = *p < 0x80 ? 1 : (*p & 0xE0) == 0xC0 ? 2 : (*p & 0xF0) == 0xE0 ? 3 : (*p & 0xF8) == 0xF0 ? 4 : 0;
+    if (length == 0 || p + length > end) {
+        *text = p + 1;
+        return 0xFFFD;
+    }
+    uint32_t character = length == 1 ? *p : *p & (0x7F >> length);
+    for (uint8_t i = 1; i < length; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            *text = p + 1;
+            return 0xFFFD;
+        }
+        character = character << 6 | (p[i] & 0x3F);
+    }
+    *text = p + length;
+    return character;
+}
+
+static void encode(uint32_t character, char *buffer) {
+    if (character == '\n' || character == '\t' || character == ' ') {
+        strcpy(buffer, character == '\n' ? "\\n" : character == '\t' ? "\\t" : "space");
+    } else if (character < 0x80) {
+        buffer[0] = character;
+        buffer[1] = '\0';
+    } else if (character < 0x800) {
+        buffer[0] = 0xC0 | character >> 6;
+        buffer[1] = 0x80 | (character & 0x3F);
+        buffer[2] = '\0';
+    } else {
+        buffer[0] = 0xE0 | character >> 12;
+        buffer[1] = 0x80 | ((character >> 6) & 0x3F);
+        buffer[2] = 0x80 | (character & 0x3F);
+        buffer[3] = '\0';
+    }
+}
+
+// Field width for printf that pads UTF-8 text to `width` characters.
+static int padding(const char *text, int width) {
+    for (; *text; text++) {
+        width += (*text & 0xC0) == 0x80;
+    }
+    return width;
+}
+
+// The character a key sends on the host, 0 if none.
+static uint32_t host_character(uint8_t usage, uint8_t mods) {
+    mods = (mods | mods >> 4) & 0x0F;
+    if (mods & (MOD_LCTL | MOD_LGUI)) {
+        return 0;
+    }
+    uint8_t     level = (mods & MOD_LSFT ? 1 : 0) | (mods & MOD_LALT ? 2 : 0);
+    const char *text  = (*host_layout)[usage][level];
+    if (usage >= KC_A && usage <= KC_Z && level < 2) {
+        char letter = usage - KC_A + (level ? 'A' : 'a');
+        if (host_layout == &de_layout && (usage == KC_Y || usage == KC_Z)) {
+            letter ^= 'y' ^ 'z';
+        }
+        return letter;
+    }
+    if (!text) {
+        return 0;
+    }
+    const uint8_t *p = (const uint8_t *)text;
+    return decode(&p, p + strlen(text));
+}
+
+/*
+ * Reverse map
+ */
+
+typedef struct {
+    uint8_t keys[32];
+    uint8_t typed;
+    uint8_t usage, mods;
+} typed_t;
+
+// Receives every report as well while `--check` types through the host.
+static void (*forward_report)(const sim_report_t *report);
+
+static void on_report(const sim_report_t *report, void *context) {
+    typed_t *typed = context;
+    for (uint16_t usage = KC_A; usage < KC_LEFT_CTRL; usage++) {
+        bool now = report->keys[usage >> 3] & (1 << (usage & 7)), before = typed->keys[usage >> 3] & (1 << (usage & 7));
+        if (now && !before) {
+            typed->typed++;
+            typed->usage = usage;
+            typed->mods  = report->mods;
+        }
+    }
+    memcpy(typed->keys, report->keys, sizeof(typed->keys));
+    if (forward_report) {
+        forward_report(report);
+    }
+}
+
+static void on_console(const char *text, void *context) {}
+
+// Runs a stroke: holds are pressed first and held past the tapping term, then the taps and chords
+// follow one after the other. Returns the character typed, 0 if none or several keys were sent.
+static uint32_t run_stroke(const stroke_t *stroke) {
+    typed_t typed = {0};
+    sim_callbacks = (sim_callbacks_t){.report = on_report, .console = on_console, .context = &typed};
+    sim_reset();
+    sim_run_until(START_TIME);
+    uint64_t time = sim_now();
+    uint8_t  i    = 0;
+    for (; i < stroke->count && stroke->presses[i].kind == PRESS_HOLD; i++) {
+        sim_run_until(time + i * 10000);
+        sim_key(stroke->presses[i].row, stroke->presses[i].col, true);
+    }
+    if (i) {
+        time += (sim_settings.tapping_term + 50) * 1000;
+    }
+    while (i < stroke->count) {
+        uint8_t first = i;
+        do {
+            sim_run_until(time + (i - first) * 5000);
+            sim_key(stroke->presses[i].row, stroke->presses[i].col, true);
+            i++;
+        } while (i < stroke->count && stroke->presses[i].kind == PRESS_CHORD && stroke->presses[first].kind == PRESS_CHORD);
+        sim_run_until(time + 40000);
+        for (uint8_t j = first; j < i; j++) {
+            sim_key(stroke->presses[j].row, stroke->presses[j].col, false);
+        }
+        time += 120000;
+    }
+    sim_run_until(time);
+    for (uint8_t j = 0; j < stroke->count && stroke->presses[j].kind == PRESS_HOLD; j++) {
+        sim_key(stroke->presses[j].row, stroke->presses[j].col, false);
+    }
+    sim_run_until(sim_now() + SETTLE_TIME);
+    return typed.typed == 1 ? host_character(typed.usage, typed.mods) : 0;
+}
+
+static void try_stroke(stroke_t *stroke) {
+    uint32_t character = run_stroke(stroke);
+    if (!character || character >= CP_LIMIT) {
+        return;
+    }
+    int16_t best = stroke_of[character];
+    if (best >= 0 && strokes[best].count <= stroke->count) {
+        return;
+    }
+    if (best < 0) {
+        if (stroke_count == MAX_STROKES) {
+            return;
+        }
+        best = stroke_count++;
+    }
+    const press_t *last = &stroke->presses[stroke->count - 1];
+    stroke->character   = character;
+    stroke->hand        = fingers[last->row][last->col] >= R_THUMB;
+    stroke->chord       = last->kind == PRESS_CHORD;
+    strokes[best]       = *stroke;
+    stroke_of[character] = best;
+}
+
+static bool is_holdable(uint16_t keycode) {
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode) || IS_QK_MOMENTARY(keycode) || IS_MODIFIER_KEYCODE(keycode) || IS_QK_TAP_DANCE(keycode) || IS_QK_ONE_SHOT_MOD(keycode) || IS_QK_ONE_SHOT_LAYER(keycode);
+}
+
+// Positions of the keys of a combo on the base layer. Returns the number of keys, 0 if one of them
+// is not on the base layer.
+static uint8_t combo_positions(uint16_t index, press_t *presses) {
+    uint8_t count = 0;
+#ifdef COMBO_ENABLE
+    uint16_t keycode;
+    while (count < 3 && (keycode = pgm_read_word(&key_combos[index].keys[count])) != COMBO_END) {
+        bool found = false;
+        for (uint8_t row = 0; row < MATRIX_ROWS && !found; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS && !found; col++) {
+                if (sim_keycode_at(0, row, col) == keycode) {
+                    presses[count++] = (press_t){.row = row, .col = col, .kind = PRESS_CHORD};
+                    found            = true;
+                }
+            }
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+#endif
+    return count;
+}
+
+static uint16_t combo_keycode(uint16_t index) {
+#ifdef COMBO_ENABLE
+    return key_combos[index].keycode;
+#else
+    return KC_NO;
+#endif
+}
+
+static void build_reverse_map(void) {
+    memset(stroke_of, -1, sizeof(stroke_of));
+    press_t positions[MATRIX_ROWS * MATRIX_COLS], holds[MATRIX_ROWS * MATRIX_COLS];
+    uint8_t hold_count = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(positions); i++) {
+        positions[i] = (press_t){.row = i / MATRIX_COLS, .col = i % MATRIX_COLS, .kind = PRESS_TAP};
+        if (is_holdable(sim_keycode_at(0, positions[i].row, positions[i].col))) {
+            holds[hold_count++] = (press_t){.row = positions[i].row, .col = positions[i].col, .kind = PRESS_HOLD};
+        }
+    }
+
+    // a tap, or a tap after a held key or a tapped (one-shot) key:
+    for (uint8_t i = 0; i < ARRAY_SIZE(positions); i++) {
+        try_stroke(&(stroke_t){.presses = {positions[i]}, .count = 1});
+    }
+    for (uint8_t h = 0; h < hold_count; h++) {
+        for (uint8_t i = 0; i < ARRAY_SIZE(positions); i++) {
+            if (holds[h].row != positions[i].row || holds[h].col != positions[i].col) {
+                try_stroke(&(stroke_t){.presses = {holds[h], positions[i]}, .count = 2});
+                press_t one_shot = {.row = holds[h].row, .col = holds[h].col, .kind = PRESS_TAP};
+                try_stroke(&(stroke_t){.presses = {one_shot, positions[i]}, .count = 2});
+            }
+        }
+    }
+
+    // a combo, alone or with a held key:
+    for (uint16_t index = 0; index < sim_combo_count(); index++) {
+        stroke_t combo = {0};
+        combo.count    = combo_positions(index, combo.presses);
+        if (!combo.count) {
+            continue;
+        }
+        try_stroke(&combo);
+        for (uint8_t h = 0; h < hold_count; h++) {
+            stroke_t held = {.presses = {holds[h]}, .count = combo.count + 1};
+            memcpy(&held.presses[1], combo.presses, combo.count * sizeof(press_t));
+            try_stroke(&held);
+        }
+    }
+
+    // a held combo (e.g. a layer) and a tap:
+    for (uint16_t index = 0; index < sim_combo_count(); index++) {
+        stroke_t combo = {0};
+        combo.count    = combo_positions(index, combo.presses);
+        if (!combo.count || !is_holdable(combo_keycode(index))) {
+            continue;
+        }
+        for (uint8_t i = 0; i < combo.count; i++) {
+            combo.presses[i].kind = PRESS_HOLD;
+        }
+        for (uint8_t i = 0; i < ARRAY_SIZE(positions); i++) {
+            stroke_t held = combo;
+            bool     free = true;
+            for (uint8_t j = 0; j < combo.count; j++) {
+                free &= combo.presses[j].row != positions[i].row || combo.presses[j].col != positions[i].col;
+            }
+            if (free) {
+                held.presses[held.count++] = positions[i];
+                try_stroke(&held);
+            }
+        }
+    }
+
+    // two held keys (e.g. shift and a layer) and a tap:
+    for (uint8_t h1 = 0; h1 < hold_count; h1++) {
+        for (uint8_t h2 = h1 + 1; h2 < hold_count; h2++) {
+            for (uint8_t i = 0; i < ARRAY_SIZE(positions); i++) {
+                try_stroke(&(stroke_t){.presses = {holds[h1], holds[h2], positions[i]}, .count = 3});
+            }
+        }
+    }
+}
+
+static void describe_stroke(const stroke_t *stroke, char *buffer, size_t size) {
+    size_t length = 0;
+    buffer[0]     = '\0';
+    for (uint8_t i = 0; i < stroke->count && length < size; i++) {
+        const press_t *press     = &stroke->presses[i];
+        bool           in_chord  = i > 0 && press->kind == PRESS_CHORD && stroke->presses[i - 1].kind == PRESS_CHORD;
+        const char    *separator = i == 0 ? "" : in_chord ? "+" : ", ";
+        const char    *prefix    = press->kind == PRESS_HOLD ? "hold " : "";
+        length += snprintf(buffer + length, size - length, "%s%s%s", separator, prefix, sim_position_name(press->row, press->col));
+    }
+}
+
+/*
+ * Corpus
+ */
+
+// Only counts are taken while reading, everything else is derived from them in the report.
+typedef struct {
+    uint64_t characters[CP_LIMIT + 1];
+    uint64_t strokes[MAX_STROKES];
+    uint64_t pairs[MAX_STROKES][MAX_STROKES]; // consecutive characters that can both be typed
+} stats_t;
+
+typedef struct {
+    FILE           *file;
+    pthread_mutex_t lock;
+    uint8_t         carry[4]; // an incomplete character at the end of the last chunk
+    size_t          carry_length;
+    uint32_t        previous; // last character of the last chunk
+    uint64_t        bytes;
+} reader_t;
+
+static void count_text(const uint8_t *text, const uint8_t *end, uint32_t previous, stats_t *stats) {
+    int16_t last = previous < CP_LIMIT ? stroke_of[previous] : -1;
+    while (text < end) {
+        uint32_t character = *text < 0x80 ? *text++ : decode(&text, end);
+        if (character == '\r') {
+            continue;
+        }
+        stats->characters[character < CP_LIMIT ? character : OTHER]++;
+        int16_t index = character < CP_LIMIT ? stroke_of[character] : -1;
+        if (index >= 0) {
+            stats->strokes[index]++;
+            if (last >= 0) {
+                stats->pairs[last][index]++;
+            }
+        }
+        last = index;
+    }
+}
+
+// Reads the next chunk, without an incomplete character at its end. Returns its length.
+static size_t read_chunk(reader_t *reader, uint8_t *buffer, uint32_t *previous) {
+    pthread_mutex_lock(&reader->lock);
+    memcpy(buffer, reader->carry, reader->carry_length);
+    size_t length = reader->carry_length + fread(buffer + reader->carry_length, 1, CHUNK_SIZE - reader->carry_length, reader->file);
+    size_t end    = length;
+    // back up to the start of the last character and keep it if it is incomplete
+    size_t start = length;
+    while (start > 0 && length - start < 4 && (buffer[start - 1] & 0xC0) == 0x80) {
+        start--;
+    }
+    if (start > 0 && length - start < 4 && buffer[start - 1] >= 0xC0) {
+        start--;
+        uint8_t needed = (buffer[start] & 0xE0) == 0xC0 ? 2 : (buffer[start] & 0xF0) == 0xE0 ? 3 : 4;
+        if (length - start < needed && !feof(reader->file)) {
+            end = start;
+        }
+    }
+    reader->carry_length = length - end;
+    memcpy(reader->carry, buffer + end, reader->carry_length);
+    *previous = reader->previous;
+    if (end > 0) {
+        const uint8_t *last = buffer + end - 1;
+        while (last > buffer && (*last & 0xC0) == 0x80) {
+            last--;
+        }
+        reader->previous = decode(&last, buffer + end);
+    }
+    reader->bytes += end;
+    pthread_mutex_unlock(&reader->lock);
+    return end;
+}
+
+typedef struct {
+    reader_t *reader;
+    stats_t  *stats;
+} worker_t;
+
+static void *work(void *context) {
+    worker_t *worker = context;
+    uint8_t  *buffer = malloc(CHUNK_SIZE);
+    size_t    length;
+    uint32_t  previous;
+    if (!buffer) {
+        perror("corpus");
+        exit(1);
+    }
+    while ((length = read_chunk(worker->reader, buffer, &previous)) > 0) {
+        count_text(buffer, buffer + length, previous, worker->stats);
+    }
+    free(buffer);
+    return NULL;
+}
+
+static uint64_t read_corpus(FILE *file, stats_t *total, unsigned threads) {
+    reader_t  reader = {.file = file, .lock = PTHREAD_MUTEX_INITIALIZER};
+    pthread_t ids[MAX_THREADS];
+    worker_t  workers[MAX_THREADS];
+    for (unsigned i = 0; i < threads; i++) {
+        workers[i] = (worker_t){.reader = &reader, .stats = calloc(1, sizeof(stats_t))};
+        if (!workers[i].stats || pthread_create(&ids[i], NULL, work, &workers[i]) != 0) {
+            perror("corpus");
+            exit(1);
+        }
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        uint64_t *from = (uint64_t *)workers[i].stats, *to = (uint64_t *)total;
+        for (size_t j = 0; j < sizeof(stats_t) / sizeof(uint64_t); j++) {
+            to[j] += from[j];
+        }
+        free(workers[i].stats);
+    }
+    return reader.bytes;
+}
+
+/*
+ * Report
+ */
+
+static double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0;
+}
+
+static const uint64_t *sort_counts;
+
+static int compare_counts(const void *a, const void *b) {
+    uint64_t first = sort_counts[*(const uint32_t *)a], second = sort_counts[*(const uint32_t *)b];
+    return first > second ? -1 : first < second;
+}
+
+// Same finger on another key (1), or only the same key again (2), between two strokes:
+static uint8_t compare_strokes(const stroke_t *first, const stroke_t *second) {
+    bool same_finger = false, same_key = false;
+    for (uint8_t i = 0; i < first->count; i++) {
+        for (uint8_t j = 0; j < second->count; j++) {
+            const press_t *a = &first->presses[i], *b = &second->presses[j];
+            if (fingers[a->row][a->col] != fingers[b->row][b->col]) {
+                continue;
+            }
+            if (a->row == b->row && a->col == b->col) {
+                same_key = true;
+            } else {
+                same_finger = true;
+            }
+        }
+    }
+    return same_finger ? 1 : same_key ? 2 : 0;
+}
+
+static void print_report(const stats_t *stats, uint64_t bytes, double seconds) {
+    uint64_t characters = 0, mapped = 0, chords = 0, presses = 0, finger_presses[FINGER_COUNT] = {0};
+    uint64_t pairs = 0, same_finger = 0, same_key = 0, alternations = 0;
+    for (uint32_t character = 0; character <= OTHER; character++) {
+        characters += stats->characters[character];
+    }
+    for (uint16_t i = 0; i < stroke_count; i++) {
+        mapped += stats->strokes[i];
+        chords += strokes[i].chord ? stats->strokes[i] : 0;
+        presses += strokes[i].count * stats->strokes[i];
+        for (uint8_t p = 0; p < strokes[i].count; p++) {
+            finger_presses[fingers[strokes[i].presses[p].row][strokes[i].presses[p].col]] += stats->strokes[i];
+        }
+        for (uint16_t j = 0; j < stroke_count; j++) {
+            uint64_t count = stats->pairs[i][j];
+            if (count) {
+                uint8_t same = compare_strokes(&strokes[i], &strokes[j]);
+                pairs += count;
+                same_finger += same == 1 ? count : 0;
+                same_key += same == 2 ? count : 0;
+                alternations += strokes[i].hand != strokes[j].hand ? count : 0;
+            }
+        }
+    }
+    printf("characters             %" PRIu64 " (%.2f %% can be typed, host layout %s)\n", characters, percent(mapped, characters), host_layout == &de_layout ? "de" : "us");
+    printf("presses per character  %.3f\n", mapped ? (double)presses / mapped : 0);
+    printf("chords                 %.2f %% of the characters\n", percent(chords, mapped));
+    printf("same-finger bigrams    %.2f %% (same key again: %.2f %%)\n", percent(same_finger, pairs), percent(same_key, pairs));
+    printf("hand alternation       %.2f %% of the bigrams\n", percent(alternations, pairs));
+    printf("\nfinger load\n");
+    for (finger_t finger = 0; finger < FINGER_COUNT; finger++) {
+        printf("  %-9s %6.2f %%\n", finger_names[finger], percent(finger_presses[finger], presses));
+    }
+
+    uint32_t order[MAX_STROKES];
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < stroke_count; i++) {
+        if (strokes[i].chord && stats->strokes[i]) order[count++] = i;
+    }
+    sort_counts = stats->strokes;
+    qsort(order, count, sizeof(uint32_t), compare_counts);
+    if (count) printf("\nchords\n");
+    for (uint16_t i = 0; i < count && i < 20; i++) {
+        char character[8], description[64];
+        encode(strokes[order[i]].character, character);
+        describe_stroke(&strokes[order[i]], description, sizeof(description));
+        printf("  %-*s %-24s %6.2f %%\n", padding(character, 6), character, description, percent(stats->strokes[order[i]], mapped));
+    }
+
+    static uint32_t missing[CP_LIMIT + 1];
+    count = 0;
+    for (uint32_t character = 0; character <= OTHER; character++) {
+        if (stats->characters[character] && (character == OTHER || stroke_of[character] < 0)) missing[count++] = character;
+    }
+    sort_counts = stats->characters;
+    qsort(missing, count, sizeof(uint32_t), compare_counts);
+    if (count) printf("\ncannot be typed\n");
+    for (uint16_t i = 0; i < count && i < 20; i++) {
+        char character[8] = "U+XXXX";
+        if (missing[i] == OTHER) {
+            strcpy(character, "other");
+        } else if (missing[i] < 0x20) {
+            snprintf(character, sizeof(character), "U+%04X", missing[i]);
+        } else {
+            encode(missing[i], character);
+        }
+        printf("  %-*s %6.2f %%\n", padding(character, 6), character, percent(stats->characters[missing[i]], characters));
+    }
+    fprintf(stderr, "%.1f MB in %.2f s: %.1f MB/s\n", bytes / 1e6, seconds, seconds > 0 ? bytes / 1e6 / seconds : 0);
+}
+
+static void print_map(void) {
+    for (uint32_t character = 0; character < CP_LIMIT; character++) {
+        if (stroke_of[character] >= 0) {
+            char text[8], description[64];
+            encode(character, text);
+            describe_stroke(&strokes[stroke_of[character]], description, sizeof(description));
+            printf("%-*s %s\n", padding(text, 6), text, description);
+        }
+    }
+}
+
+#ifdef XKB_ENABLE
+/*
+ * Check through the host (--check): the reports go through the kernel's HID driver (uhid) to an
+ * input device, whose key events an XKB keymap turns into text, as on a Linux desktop.
+ */
+
+typedef struct {
+    int                uhid, evdev;
+    struct xkb_state  *state;
+    char               text[64]; // what the host typed for the current stroke
+    size_t             length;
+} checker_t;
+
+static checker_t checker;
+
+// A keyboard with the modifiers and a bitmap of all usages, like QMK's NKRO report:
+static const uint8_t report_descriptor[] = {
+    0x05, 0x01,       // Usage Page (Generic Desktop)
+    0x09, 0x06,       // Usage (Keyboard)
+    0xA1, 0x01,       // Collection (Application)
+    0x05, 0x07,       //   Usage Page (Keyboard/Keypad)
+    0x19, 0xE0,       //   Usage Minimum (Left Control)
+    0x29, 0xE7,       //   Usage Maximum (Right GUI)
+    0x15, 0x00,       //   Logical Minimum (0)
+    0x25, 0x01,       //   Logical Maximum (1)
+    0x75, 0x01,       //   Report Size (1)
+    0x95, 0x08,       //   Report Count (8)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0x19, 0x00,       //   Usage Minimum (0)
+    0x29, 0xFF,       //   Usage Maximum (255)
+    0x96, 0x00, 0x01, //   Report Count (256)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0xC0,             // End Collection
+};
+
+// Passes the key events the kernel made of the last report to the XKB state.
+static void read_host_events(void) {
+    struct input_event events[64];
+    ssize_t            length;
+    while ((length = read(checker.evdev, events, sizeof(events))) > 0) {
+        for (size_t i = 0; i < length / sizeof(struct input_event); i++) {
+            if (events[i].type != EV_KEY || events[i].value > 1) {
+                continue; // not a key, or auto-repeat
+            }
+            xkb_keycode_t keycode = events[i].code + 8; // evdev to XKB
+            if (events[i].value) {
+                checker.length += xkb_state_key_get_utf8(checker.state, keycode, checker.text + checker.length, sizeof(checker.text) - checker.length);
+                checker.length = checker.length < sizeof(checker.text) ? checker.length : sizeof(checker.text) - 1;
+            }
+            xkb_state_update_key(checker.state, keycode, events[i].value ? XKB_KEY_DOWN : XKB_KEY_UP);
+        }
+    }
+}
+
+static void send_host_report(const sim_report_t *report) {
+    struct uhid_event event = {.type = UHID_INPUT2};
+    event.u.input2.size     = 1 + sizeof(report->keys);
+    event.u.input2.data[0]  = report->mods;
+    memcpy(event.u.input2.data + 1, report->keys, sizeof(report->keys));
+    if (write(checker.uhid, &event, sizeof(event)) < 0) {
+        perror("corpus: /dev/uhid");
+        exit(1);
+    }
+    read_host_events(); // the kernel handles the report within write()
+}
+
+// Creates the virtual keyboard and opens its input device exclusively, so that its keys do not
+// reach the desktop.
+static void open_host(const char *layout, const char *options) {
+    char name[64], path[PATH_MAX], found[128];
+    snprintf(name, sizeof(name), "zilpzalp corpus %d", (int)getpid());
+    checker.uhid = open("/dev/uhid", O_RDWR | O_CLOEXEC);
+    if (checker.uhid < 0) {
+        perror("corpus: /dev/uhid (load the uhid module, run as root or with access to it)");
+        exit(1);
+    }
+    struct uhid_event event = {.type = UHID_CREATE2};
+    snprintf((char *)event.u.create2.name, sizeof(event.u.create2.name), "%s", name);
+    memcpy(event.u.create2.rd_data, report_descriptor, sizeof(report_descriptor));
+    event.u.create2.rd_size = sizeof(report_descriptor);
+    event.u.create2.bus     = BUS_VIRTUAL;
+    if (write(checker.uhid, &event, sizeof(event)) < 0) {
+        perror("corpus: /dev/uhid");
+        exit(1);
+    }
+    checker.evdev = -1;
+    for (unsigned attempt = 0; attempt < 200 && checker.evdev < 0; attempt++) {
+        usleep(10000); // the input device appears asynchronously
+        glob_t paths;
+        if (glob("/sys/class/input/event*/device/name", 0, NULL, &paths) != 0) {
+            continue;
+        }
+        for (size_t i = 0; i < paths.gl_pathc && checker.evdev < 0; i++) {
+            FILE *file = fopen(paths.gl_pathv[i], "r");
+            if (file && fgets(found, sizeof(found), file) && strncmp(found, name, strlen(name)) == 0 && found[strlen(name)] == '\n') {
+                unsigned number;
+                sscanf(paths.gl_pathv[i], "/sys/class/input/event%u", &number);
+                snprintf(path, sizeof(path), "/dev/input/event%u", number);
+                checker.evdev = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+                if (checker.evdev >= 0 && ioctl(checker.evdev, EVIOCGRAB, 1) != 0) {
+                    perror("corpus: EVIOCGRAB");
+                    exit(1);
+                }
+            }
+            if (file) fclose(file);
+        }
+        globfree(&paths);
+    }
+    if (checker.evdev < 0) {
+        fprintf(stderr, "corpus: the input device of the virtual keyboard did not appear\n");
+        exit(1);
+    }
+
+    // "de(mac)" is layout "de" with variant "mac":
+    char names[64], *variant = NULL;
+    snprintf(names, sizeof(names), "%s", layout);
+    if ((variant = strchr(names, '('))) {
+        *variant++                     = '\0';
+        variant[strcspn(variant, ")")] = '\0';
+    }
+    struct xkb_rule_names rules   = {.rules = "evdev", .model = "pc105", .layout = names, .variant = variant, .options = options};
+    struct xkb_context   *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+    struct xkb_keymap    *keymap  = context ? xkb_keymap_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS) : NULL;
+    if (!keymap) {
+        fprintf(stderr, "corpus: cannot compile the XKB layout '%s'\n", layout);
+        exit(1);
+    }
+    checker.state = xkb_state_new(keymap);
+}
+
+// Types a character with its stroke and compares it with what the host makes of the reports.
+// Returns whether it came out differently; the first time, the difference is printed.
+static bool check_character(uint32_t character) {
+    static uint32_t wrong[CP_LIMIT];
+    checker.length  = 0;
+    checker.text[0] = '\0';
+    run_stroke(&strokes[stroke_of[character]]);
+    const uint8_t *text = (const uint8_t *)checker.text;
+    if (checker.length && decode(&text, text + checker.length) == character && text == (const uint8_t *)checker.text + checker.length) {
+        return false;
+    }
+    if (!wrong[character]++) {
+        char expected[8], description[64];
+        encode(character, expected);
+        describe_stroke(&strokes[stroke_of[character]], description, sizeof(description));
+        printf("%-*s %-28s the host typed '%s'\n", padding(expected, 6), expected, description, checker.text);
+    }
+    return true;
+}
+
+// Types the characters of the files, or all that the keymap can type, as they are read. Returns
+// the number of characters that came out differently.
+static size_t check_host(const char *layout, const char *options, char **files, int file_count) {
+    size_t count = 0, mismatches = 0, skipped = 0;
+    open_host(layout, options);
+    forward_report = send_host_report;
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < file_count; i++) {
+        FILE *file = fopen(files[i], "rb");
+        if (!file) {
+            fprintf(stderr, "corpus: %s: %s\n", files[i], strerror(errno));
+            exit(1);
+        }
+        static uint8_t buffer[CHUNK_SIZE];
+        reader_t       reader = {.file = file, .lock = PTHREAD_MUTEX_INITIALIZER};
+        uint32_t       previous;
+        size_t         length;
+        while ((length = read_chunk(&reader, buffer, &previous)) > 0) {
+            const uint8_t *text = buffer, *end = buffer + length;
+            while (text < end) {
+                uint32_t character = decode(&text, end);
+                if (character >= CP_LIMIT || stroke_of[character] < 0) {
+                    skipped++;
+                    continue;
+                }
+                count++;
+                mismatches += check_character(character);
+            }
+        }
+        fclose(file);
+    }
+    if (!file_count) {
+        for (uint32_t character = 0; character < CP_LIMIT; character++) {
+            if (stroke_of[character] >= 0) {
+                count++;
+                mismatches += check_character(character);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+    fprintf(stderr, "%zu characters in %.2f s: %.0f characters/s, %zu typed differently, %zu skipped (no stroke)\n", count, seconds, count / seconds, mismatches, skipped);
+    return mismatches;
+}
+#endif
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: corpus [options] [file...]\n"
+            "  --host de|us           layout of the host (default " SIM_HOST_LAYOUT ", from the keymap)\n"
+            "  -j, --threads N        number of threads (default: one per CPU)\n"
+            "  -m, --map              print the stroke of each character and exit\n"
+            "  --check LAYOUT         type the characters of the files (default: of the map) through the\n"
+            "                         kernel and compare what an XKB layout makes of them, e.g. de(mac)\n"
+            "  --xkb-options OPTIONS  for --check, e.g. lv3:lalt_switch\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"host", required_argument, NULL, 'h'},
+        {"threads", required_argument, NULL, 'j'},
+        {"map", no_argument, NULL, 'm'},
+        {"check", required_argument, NULL, 'c'},
+#ifdef XKB_ENABLE
+        {"xkb-options", required_argument, NULL, 'x'},
+#endif
+        {NULL, 0, NULL, 0},
+    };
+    const char *host    = SIM_HOST_LAYOUT;
+    long        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    bool        map     = false;
+    const char *check   = NULL;
+#ifdef XKB_ENABLE
+    const char *xkb_options = NULL;
+#endif
+    int         option;
+    while ((option = getopt_long(argc, argv, "j:m", options, NULL)) != -1) {
+        switch (option) {
+            // clang-format off
+            case 'h': host = optarg; break;
+            case 'j': threads = strtol(optarg, NULL, 10); break;
+            case 'm': map = true; break;
+            case 'c': check = optarg; break;
+#ifdef XKB_ENABLE
+            case 'x': xkb_options = optarg; break;
+#endif
+            default: usage();
+            // clang-format on
+        }
+    }
+    if (strcmp(host, "de") != 0 && strcmp(host, "us") != 0) {
+        usage();
+    }
+    host_layout = strcmp(host, "de") == 0 ? &de_layout : &us_layout;
+    threads     = threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+
+    sim_default_settings();
+    build_reverse_map();
+    if (map) {
+        print_map();
+        return 0;
+    }
+    if (check) {
+#ifdef XKB_ENABLE
+        return check_host(check, xkb_options, argv + optind, argc - optind) ? 1 : 0;
+#else
+        fprintf(stderr, "corpus: --check needs libxkbcommon (pkg-config xkbcommon) when the tools are built\n");
+        return 2;
+#endif
+    }
+
+    static stats_t  stats;
+    uint64_t        bytes = 0;
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    if (optind == argc) {
+        bytes += read_corpus(stdin, &stats, threads);
+    }
+    for (int i = optind; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (!file) {
+            fprintf(stderr, "corpus: %s: %s\n", argv[i], strerror(errno));
+            return 1;
+        }
+        bytes += read_corpus(file, &stats, threads);
+        fclose(file);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    print_report(&stats, bytes, (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9);
+    return 0;
+}
@@ -0,0 +1,300 @@
+#!/usr/bin/env python3
+"""Builds the firmware of each keymap and reports its size, stack depth and reachable code.
+
+    tools/fwreport.py --qmk-home ~/qmk_firmware [keymap...]
+
+For each keymap (all but vial by default, see Makefile) the firmware is built with QMK's make and
+`-fstack-usage -fcallgraph-info=su` (GCC 10 or newer). The report lists:
+
+  - flash and RAM of the firmware, and of each module: the files of features/, zilpzalp.c, the
+    keymap, QMK's process_keycode/ features, the rest of QMK, ChibiOS and the C library (from the
+    linker map);
+  - the worst-case stack depth of the event path (`action_exec`) and of the keyboard's hooks, from
+    the call graph GCC writes for every file;
+  - the reachable code of these entry points: the instructions of all functions they may call,
+    summed up (calls through pointers, e.g. tap dance actions, are not followed). This is code
+    size, not the cost of one event: a branch that is never taken counts as much as the loop that
+    runs for every key. It shows when more code hangs off the event path.
+
+The report is written as JSON (`--output`) and compared with a baseline (`--baseline`). The
+command fails if the stack or the reachable code of an entry point grows by more than
+`--tolerance` percent, or if a keymap is not in the baseline; flash and RAM changes are listed.
+`--update-baseline` stores the new report as baseline.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+KEYMAPS = os.path.join(TOOLS, "..", "keymaps")
+ENTRY_POINTS = ["action_exec", "pre_process_record_kb", "process_record_kb", "housekeeping_task_kb", "matrix_scan_kb"]
+EXTRAFLAGS = "-fstack-usage -fcallgraph-info=su"
+
+
+def build(args, keymap):
+    command = ["make", "-C", args.qmk_home, f"{args.keyboard}:{keymap}", f"EXTRAFLAGS={EXTRAFLAGS}", f"-j{os.cpu_count() or 1}"]
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout)
+        sys.exit(f"fwreport: building {keymap} failed")
+
+
+def module_of(path):
+    """Name of the module an object file of the map belongs to."""
+    path = path.replace("\\", "/")
+    if match := re.search(r"keyboards/[^ ]*?/features/(\w+)\.o", path):
+        return f"features/{match.group(1)}"
+    if "/keymaps/" in path:
+        return "keymap"
+    if "keyboards/" in path:
+        return "zilpzalp"
+    if match := re.search(r"quantum/process_keycode/(\w+)\.o", path):
+        return f"qmk {match.group(1)}"
+    if "quantum/" in path or "tmk_core/" in path or "platforms/" in path:
+        return "qmk"
+    if "chibios" in path.lower():
+        return "chibios"
+    if re.search(r"lib(c|c_nano|gcc|m|nosys)\.a", path):
+        return "libc"
+    return "other"
+
+
+def section_kind(name):
+    """Where an input section ends up: 'flash', 'ram' or 'both' (initialized data), None if nowhere."""
+    if name.startswith((".text", ".rodata", ".boot2", ".vectors", ".ARM.ex")):
+        return "flash"
+    if name.startswith(".data") or name.startswith(".ramtext"):
+        return "both"
+    if name.startswith((".bss", ".noinit")) or name == "COMMON":
+        return "ram"
+    return None
+
+
+def parse_map(path):
+    """Flash and RAM per module from the input sections of a GNU ld map file."""
+    modules = {}
+    section = None
+    in_memory_map = False
+    pattern = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$")
+    with open(path, errors="replace") as file:
+        for line in file:
+            if not in_memory_map:
+                in_memory_map = line.startswith("Linker script and memory map")
+                continue
+            if line.startswith(" .") or line.startswith(" COMMON"):
+                parts = line.split(None, 1)
+                section = parts[0]
+                rest = " " + parts[1] if len(parts) > 1 else ""
+                if not rest.strip():
+                    continue  # address, size and file follow on the next line
+                line = rest
+            match = pattern.match(line)
+            if not section or not match:
+                continue
+            address, size, file_name = int(match.group(1), 16), int(match.group(2), 16), match.group(3)
+            kind = section_kind(section)
+            section = None
+            if not kind or address == 0 or size == 0:
+                continue
+            entry = modules.setdefault(module_of(file_name), {"flash": 0, "ram": 0})
+            if kind in ("flash", "both"):
+                entry["flash"] += size
+            if kind in ("ram", "both"):
+                entry["ram"] += size
+    return dict(sorted(modules.items()))
+
+
+def firmware_size(args, elf):
+    """Flash and RAM of the whole firmware (Berkeley format of size: text data bss)."""
+    output = subprocess.run([args.prefix + "size", elf], stdout=subprocess.PIPE, text=True, check=True).stdout
+    text, data, bss = (int(value) for value in output.splitlines()[1].split()[:3])
+    return text + data, data + bss
+
+
+def parse_callgraphs(obj_dir):
+    """Stack usage and callees of every function, from the .ci files of the build."""
+    functions = {}  # title: {"stack": bytes or None, "calls": set of titles, "file": object file}
+    node = re.compile(r'node: \{ title: "([^"]+)"(?: label: "[^"]*\\n(\d+) bytes \(([^)]*)\)")?')
+    edge = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+    for root, _, files in os.walk(obj_dir):
+        for name in files:
+            if not name.endswith(".ci"):
+                continue
+            object_file = os.path.join(root, name[:-3] + ".o")
+            with open(os.path.join(root, name), errors="replace") as file:
+                for line in file:
+                    if match := node.match(line):
+                        title, stack = match.group(1), match.group(2)
+                        entry = functions.setdefault(title, {"stack": None, "calls": set(), "file": None})
+                        if stack is not None:
+                            entry["stack"] = int(stack)
+                            entry["file"] = object_file
+                    elif match := edge.match(line):
+                        functions.setdefault(match.group(1), {"stack": None, "calls": set(), "file": None})["calls"].add(match.group(2))
+    return functions
+
+
+def count_instructions(args, functions):
+    """Instructions of each defined function, from the disassembly of its object file."""
+    counts = {}
+    by_object = {}
+    for title, entry in functions.items():
+        if entry["file"]:
+            by_object.setdefault(entry["file"], set()).add(title)
+    start = re.compile(r"^[0-9a-f]+ <([^>]+)>:$")
+    instruction = re.compile(r"^\s+[0-9a-f]+:\t")
+    for object_file, titles in by_object.items():
+        # static functions are titled "file.c:name" in the call graph, global ones "name"
+        names = {title.rsplit(":", 1)[-1]: title for title in titles}
+        output = subprocess.run([args.prefix + "objdump", "-d", "--no-show-raw-insn", object_file], stdout=subprocess.PIPE, text=True, check=True).stdout
+        current = None
+        for line in output.splitlines():
+            if match := start.match(line):
+                current = names.get(match.group(1))
+                if current:
+                    counts[current] = 0
+            elif current and instruction.match(line):
+                counts[current] += 1
+    return counts
+
+
+def worst_stack(functions, title, memo, active):
+    """Deepest stack below a function; recursion and unknown functions count 0."""
+    if title in memo:
+        return memo[title]
+    if title in active:
+        return 0
+    entry = functions.get(title)
+    if not entry:
+        return 0
+    active.add(title)
+    deepest = max((worst_stack(functions, callee, memo, active) for callee in entry["calls"]), default=0)
+    active.discard(title)
+    memo[title] = (entry["stack"] or 0) + deepest
+    return memo[title]
+
+
+def reachable(functions, title):
+    seen, stack = set(), [title]
+    while stack:
+        current = stack.pop()
+        if current in seen:
+            continue
+        seen.add(current)
+        stack.extend(functions.get(current, {}).get("calls", ()))
+    return seen
+
+
+def analyze(args, keymap):
+    if not args.no_build:
+        build(args, keymap)
+    target = f"{args.keyboard.replace('/', '_')}_{keymap}"
+    build_dir = os.path.join(args.qmk_home, ".build")
+    elf = os.path.join(build_dir, f"{target}.elf")
+    flash, ram = firmware_size(args, elf)
+    functions = parse_callgraphs(os.path.join(build_dir, f"obj_{target}"))
+    if not functions:
+        sys.exit(f"fwreport: no call graphs for {keymap}, was it built with {EXTRAFLAGS}?")
+    instructions = count_instructions(args, functions)
+    memo = {}
+    entry_points = {}
+    for entry_point in ENTRY_POINTS:
+        if functions.get(entry_point, {}).get("stack") is None:
+            continue
+        functions_reached = reachable(functions, entry_point)
+        entry_points[entry_point] = {
+            "stack": worst_stack(functions, entry_point, memo, set()),
+            "reachable_code": sum(instructions.get(title, 0) for title in functions_reached),
+            "functions": len(functions_reached),
+            "unknown": sorted(title for title in functions_reached if functions.get(title, {}).get("stack") is None),
+        }
+    return {"flash": flash, "ram": ram, "modules": parse_map(os.path.join(build_dir, f"{target}.map")), "entry_points": entry_points}
+
+
+def growth(old, new):
+    return (new - old) * 100.0 / old if old else (0.0 if new == old else float("inf"))
+
+
+def compare(report, baseline, tolerance):
+    """Prints the changes against the baseline. Returns False if an entry point grew too much or a
+    keymap cannot be compared."""
+    ok = True
+    for keymap, current in report.items():
+        previous = baseline.get(keymap)
+        if not previous:
+            print(f"{keymap}: not in the baseline, add it with --update-baseline")
+            ok = False
+            continue
+        for name in ("flash", "ram"):
+            if current[name] != previous[name]:
+                print(f"{keymap}: {name} {previous[name]} -> {current[name]} ({growth(previous[name], current[name]):+.1f} %)")
+        for module in sorted(set(current["modules"]) | set(previous["modules"])):
+            old = previous["modules"].get(module, {"flash": 0, "ram": 0})
+            new = current["modules"].get(module, {"flash": 0, "ram": 0})
+            if old != new:
+                print(f"{keymap}: {module} flash {old['flash']} -> {new['flash']}, ram {old['ram']} -> {new['ram']}")
+        for entry_point, new in current["entry_points"].items():
+            old = previous["entry_points"].get(entry_point)
+            if not old:
+                continue
+            for name in ("stack", "reachable_code"):
+                change = growth(old[name], new[name])
+                if change > tolerance:
+                    print(f"{keymap}: {entry_point} {name} {old[name]} -> {new[name]} ({change:+.1f} %), above the tolerance")
+                    ok = False
+                elif old[name] != new[name]:
+                    print(f"{keymap}: {entry_point} {name} {old[name]} -> {new[name]} ({change:+.1f} %)")
+    return ok
+
+
+def print_summary(report):
+    for keymap, current in report.items():
+        print(f"{keymap}: flash {current['flash']}, ram {current['ram']}")
+        for module, size in current["modules"].items():
+            print(f"  {module:<28} flash {size['flash']:>7}  ram {size['ram']:>6}")
+        for entry_point, cost in current["entry_points"].items():
+            print(f"  {entry_point:<28} stack {cost['stack']:>5}  reachable code {cost['reachable_code']:>6} instructions in {cost['functions']} functions")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Firmware size, stack depth and reachable code of the keymaps.")
+    parser.add_argument("keymaps", nargs="*", help="keymaps to report (default: all but vial)")
+    parser.add_argument("--qmk-home", default=os.environ.get("QMK_HOME", os.path.expanduser("~/qmk_firmware")))
+    parser.add_argument("--keyboard", default="zilpzalp", help="the keyboard's directory in qmk_firmware/keyboards")
+    parser.add_argument("--prefix", default="arm-none-eabi-", help="prefix of size and objdump")
+    parser.add_argument("--no-build", action="store_true", help="report on the existing build")
+    parser.add_argument("--output", help="write the report as JSON")
+    parser.add_argument("--baseline", default=os.path.join(TOOLS, "fwreport-baseline.json"))
+    parser.add_argument("--update-baseline", action="store_true", help="store the report as the new baseline")
+    parser.add_argument("--tolerance", type=float, default=0.0, help="allowed growth of the entry points, in percent")
+    args = parser.parse_args()
+
+    keymaps = args.keymaps or sorted(name for name in os.listdir(KEYMAPS) if name != "vial")
+    report = {keymap: analyze(args, keymap) for keymap in keymaps}
+    print_summary(report)
+    if args.output:
+        with open(args.output, "w") as file:
+            json.dump(report, file, indent=2, sort_keys=True)
+    if args.update_baseline:
+        baseline = {}
+        if os.path.exists(args.baseline):
+            with open(args.baseline) as file:
+                baseline = json.load(file)
+        baseline.update(report)
+        with open(args.baseline, "w") as file:
+            json.dump(baseline, file, indent=2, sort_keys=True)
+        return 0
+    if not os.path.exists(args.baseline):
+        print(f"no baseline at {args.baseline}, create one with --update-baseline")
+        return 1
+    with open(args.baseline) as file:
+        baseline = json.load(file)
+    return 0 if compare(report, baseline, args.tolerance) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,3 @@
+#pragma once
+
+#define TAPPING_TERM 200
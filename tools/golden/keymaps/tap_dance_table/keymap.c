@@ -0,0 +1,45 @@
+#include QMK_KEYBOARD_H
+#include "zilpzalp.h"
+
+// Tests the kinds of entries of features/tap_dance_table.h, see golden/tap_dance_table/.
+
+enum tapdances {
+    TD_CTL_SLSH,
+    TD_F01_F11,
+    TD_COMM_SCLN,
+    TD_DOT,
+};
+
+const tap_dance_table_entry_t PROGMEM tap_dance_table[] = {
+    [TD_CTL_SLSH]  = {KC_SLASH, KC_LCTL, KC_NO},
+    [TD_F01_F11]   = {KC_F1,    KC_NO,   KC_F11},
+    [TD_COMM_SCLN] = {KC_COMMA, KC_NO,   KC_SCLN, true, KC_BSPC},
+    [TD_DOT]       = {KC_DOT,   KC_NO,   KC_NO,   true},
+};
+tap_dance_action_t tap_dance_actions[] = {
+    [TD_CTL_SLSH]  = ACTION_TAP_DANCE_TABLE(TD_CTL_SLSH),
+    [TD_F01_F11]   = ACTION_TAP_DANCE_TABLE(TD_F01_F11),
+    [TD_COMM_SCLN] = ACTION_TAP_DANCE_TABLE(TD_COMM_SCLN),
+    [TD_DOT]       = ACTION_TAP_DANCE_TABLE(TD_DOT),
+};
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    /*
+     *     ┌───┬───┬───┬───┐        ┌───┬───┬───┬───┐
+     *     │ W │ E │ R │ T │        │ Y │ U │ I │ O │
+     * ┌───┼───┼───┼───┼───┤        ├───┼───┼───┼───┼───┐
+     * │ A │ S │ D │ F │ G │        │ H │ J │ K │ L │ P │
+     * └───┼───┼───┼───┼───┘        └───┼───┼───┼───┼───┘
+     *     │c /│F1 │ , │            │ . │ M │ N │
+     *     └───┴───┼───┼───┐    ┌───┼───┼───┴───┘
+     *             │SPC│ENT│    │ENT│SPC│
+     *             └───┴───┘    └───┴───┘
+     *  F1 sends F11 on a double tap, "," sends ";" (eager, undone with Backspace), "." is eager.
+     */
+    [0] = LAYOUT(
+                 KC_W,    KC_E,    KC_R,    KC_T,    KC_Y,    KC_U,    KC_I,    KC_O,
+        KC_A,    KC_S,    KC_D,    KC_F,    KC_G,    KC_H,    KC_J,    KC_K,    KC_L,    KC_P,
+                 TD(TD_CTL_SLSH), TD(TD_F01_F11), TD(TD_COMM_SCLN),  TD(TD_DOT), KC_M, KC_N,
+                                   KC_SPC,  KC_ENT,  KC_ENT,  KC_SPC
+    ),
+};
@@ -0,0 +1,2 @@
+TAP_DANCE_ENABLE = yes
+TAP_DANCE_TABLE_ENABLE = yes
@@ -0,0 +1,196 @@
+// Computes the latency of the keyboard itself from the console output of LATENCY_PROBE_ENABLE
+// (see features/latency_probe.h), as measured on the device:
+//
+//   firmware  from the key's contact to the report handed to the USB stack (debouncing, tap-hold,
+//             combos and the keymap's code)
+//   usb       from there until the host picked the report up (USB polling)
+//   total     both
+//
+//   build/puq/hwlatency console.txt
+//   build/puq/hwlatency before.txt after.txt     # one table per firmware
+//   build/puq/hwlatency -v console.txt           # also every sample
+//
+// The samples are grouped by the `latency begin` line of the test mode, which names the keymap,
+// its timing settings and the features that act on key events, so captures of several firmwares
+// (or several runs of one) can be given at once. Without a file name the capture is read from
+// stdin.
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+
+#define LATENCY_PROBE_PRESSED 0x80 // as in features/latency_probe.h, which is only compiled with LATENCY_PROBE_ENABLE
+#define LATENCY_PROBE_COMBO 0x7F
+
+typedef enum { PRESS, RELEASE, COMBO_PRESS, EVENT_COUNT } event_kind_t;
+typedef enum { FIRMWARE, USB, TOTAL, INTERVAL_COUNT } interval_t;
+
+static const char *event_names[]    = {"press", "release", "combo"};
+static const char *interval_names[] = {"firmware", "usb", "total"};
+
+typedef struct {
+    uint32_t *values; // µs
+    size_t    count, capacity;
+} samples_t;
+
+typedef struct {
+    char     *settings; // the `latency begin` line after "begin"
+    samples_t samples[EVENT_COUNT][INTERVAL_COUNT];
+    size_t    no_report[EVENT_COUNT];
+    size_t    dropped;
+} firmware_t;
+
+static firmware_t *firmwares;
+static size_t      firmware_count;
+static bool        verbose;
+
+static void add_sample(samples_t *samples, uint32_t value) {
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity ? samples->capacity * 2 : 1024;
+        samples->values   = realloc(samples->values, samples->capacity * sizeof(uint32_t));
+        if (!samples->values) {
+            perror("hwlatency");
+            exit(1);
+        }
+    }
+    samples->values[samples->count++] = value;
+}
+
+static firmware_t *find_firmware(const char *settings) {
+    for (size_t i = 0; i < firmware_count; i++) {
+        if (strcmp(firmwares[i].settings, settings) == 0) {
+            return &firmwares[i];
+        }
+    }
+    firmwares = realloc(firmwares, (firmware_count + 1) * sizeof(firmware_t));
+    if (!firmwares) {
+        perror("hwlatency");
+        exit(1);
+    }
+    firmwares[firmware_count] = (firmware_t){.settings = strdup(settings)};
+    return &firmwares[firmware_count++];
+}
+
+static const char *key_name(uint8_t key) {
+    key &= ~LATENCY_PROBE_PRESSED;
+    return key == LATENCY_PROBE_COMBO ? "combo" : sim_position_name(key >> 4, key & 0x0F);
+}
+
+static void read_capture(FILE *file, const char *file_name) {
+    char        line[512];
+    firmware_t *firmware = NULL;
+    while (fgets(line, sizeof(line), file)) {
+        char         *text = strstr(line, "latency ");
+        unsigned      key, dropped;
+        unsigned long edge, queued, acked;
+        if (!text) {
+            continue;
+        }
+        text += 8;
+        if (strncmp(text, "begin ", 6) == 0) {
+            text[strcspn(text, "\r\n")] = '\0';
+            firmware                    = find_firmware(text + 6);
+            continue;
+        }
+        if (!firmware) {
+            continue; // before the first `latency begin`
+        }
+        if (sscanf(text, "end %u", &dropped) == 1) {
+            firmware->dropped += dropped;
+            firmware = NULL;
+            continue;
+        }
+        int fields = sscanf(text, "%2x %8lx %8lx %8lx", &key, &edge, &queued, &acked);
+        if (fields != 2 && fields != 4) {
+            continue; // garbled by other console output
+        }
+        event_kind_t kind = (key & ~LATENCY_PROBE_PRESSED) == LATENCY_PROBE_COMBO ? COMBO_PRESS : key & LATENCY_PROBE_PRESSED ? PRESS : RELEASE;
+        if (fields == 2) {
+            firmware->no_report[kind]++;
+            if (verbose) printf("%-4s %-5s  no report\n", key & LATENCY_PROBE_PRESSED ? "down" : "up", key_name(key));
+            continue;
+        }
+        uint32_t intervals[INTERVAL_COUNT] = {(uint32_t)(queued - edge), (uint32_t)(acked - queued), (uint32_t)(acked - edge)};
+        for (interval_t interval = 0; interval < INTERVAL_COUNT; interval++) {
+            add_sample(&firmware->samples[kind][interval], intervals[interval]);
+        }
+        if (verbose) {
+            printf("%-4s %-5s  firmware %8.3f ms  usb %6.3f ms\n", key & LATENCY_PROBE_PRESSED ? "down" : "up", key_name(key), intervals[FIRMWARE] / 1e3, intervals[USB] / 1e3);
+        }
+    }
+    if (ferror(file)) {
+        fprintf(stderr, "hwlatency: %s: %s\n", file_name, strerror(errno));
+        exit(1);
+    }
+}
+
+static int compare_values(const void *a, const void *b) {
+    uint32_t first = *(const uint32_t *)a, second = *(const uint32_t *)b;
+    return first < second ? -1 : first > second;
+}
+
+static double percentile(const samples_t *samples, unsigned percent) {
+    return samples->values[(samples->count - 1) * percent / 100] / 1e3;
+}
+
+static void print_firmware(firmware_t *firmware) {
+    printf("== %s\n", firmware->settings);
+    printf("%-8s %-9s %7s %8s %8s %8s %8s %8s\n", "event", "interval", "samples", "min ms", "median", "p90", "p99", "max");
+    for (event_kind_t kind = 0; kind < EVENT_COUNT; kind++) {
+        for (interval_t interval = 0; interval < INTERVAL_COUNT; interval++) {
+            samples_t *samples = &firmware->samples[kind][interval];
+            if (!samples->count) {
+                continue;
+            }
+            qsort(samples->values, samples->count, sizeof(uint32_t), compare_values);
+            printf("%-8s %-9s %7zu %8.2f %8.2f %8.2f %8.2f %8.2f\n", event_names[kind], interval_names[interval], samples->count, samples->values[0] / 1e3, percentile(samples, 50), percentile(samples, 90), percentile(samples, 99), samples->values[samples->count - 1] / 1e3);
+        }
+    }
+    printf("No report: %zu presses, %zu releases, %zu combos. Not recorded (buffer full): %zu.\n", firmware->no_report[PRESS], firmware->no_report[RELEASE], firmware->no_report[COMBO_PRESS], firmware->dropped);
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: hwlatency [options] [console.txt...]\n"
+            "  -v, --verbose          print every sample\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"verbose", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0},
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "v", options, NULL)) != -1) {
+        switch (option) {
+            // clang-format off
+            case 'v': verbose = true; break;
+            default: usage();
+            // clang-format on
+        }
+    }
+    if (optind == argc) {
+        read_capture(stdin, "stdin");
+    }
+    for (int i = optind; i < argc; i++) {
+        FILE *file = fopen(argv[i], "r");
+        if (!file) {
+            fprintf(stderr, "hwlatency: %s: %s\n", argv[i], strerror(errno));
+            return 1;
+        }
+        read_capture(file, argv[i]);
+        fclose(file);
+    }
+    if (!firmware_count) {
+        fprintf(stderr, "hwlatency: no `latency begin` line, is LATENCY_PROBE on?\n");
+        return 1;
+    }
+    for (size_t i = 0; i < firmware_count; i++) {
+        print_firmware(&firmwares[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,289 @@
+// Converts the key log recorded with KEYLOG_ENABLE (see features/keylog.h) from the console output
+// of the keyboard into a compact binary trace, and binary traces into text for the other tools.
+//
+//   build/puq/keylog -o typing.bin console.txt    # console output to a binary trace
+//   build/puq/keylog typing.bin                   # list the events
+//   build/puq/keylog --replay typing.bin | build/puq/replay --tapping-term 180
+//   build/puq/keylog --simulate typing.bin        # as a `simulate` script
+//
+// The input is either a binary trace or the console output (`qmk console > console.txt`, other
+// lines are ignored), which may hold several dumps. Without a file name it is read from stdin.
+//
+// A binary trace is a 16-byte header, "ZKL1", the number of entries (uint32) and the time of the
+// first entry in µs (uint64), followed by the entries as the keyboard stores them (4 bytes each,
+// little-endian, see `keylog_entry_t`). The first entry's delta is 0.
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+
+#define START_TIME 100000 // µs, the keyboard has been running for a while when the log starts
+#define MAGIC "ZKL1"
+#define HEADER_SIZE 16
+#define KEYLOG_PRESSED 0x80 // as in features/keylog.h, which is only compiled with KEYLOG_ENABLE
+#define KEYLOG_GAP 0x7F
+
+typedef struct {
+    uint64_t time; // µs since the keyboard started
+    uint8_t  key;  // row << 4 | col
+    bool     pressed;
+    uint8_t  layers;
+} event_t;
+
+typedef struct {
+    event_t *events;
+    size_t   count, capacity;
+    size_t   dumps, dropped;
+} events_t;
+
+static void push_event(events_t *events, event_t event) {
+    if (events->count == events->capacity) {
+        events->capacity = events->capacity ? events->capacity * 2 : 1024;
+        events->events   = realloc(events->events, events->capacity * sizeof(event_t));
+        if (!events->events) {
+            perror("keylog");
+            exit(1);
+        }
+    }
+    events->events[events->count++] = event;
+}
+
+static uint32_t advance(uint16_t delta, uint8_t key) {
+    return key == KEYLOG_GAP ? (uint32_t)delta << 16 : delta;
+}
+
+static void add_entry(events_t *events, uint64_t time, uint8_t key, uint8_t layers) {
+    if (key != KEYLOG_GAP) {
+        push_event(events, (event_t){.time = time, .key = key & ~KEYLOG_PRESSED, .pressed = key & KEYLOG_PRESSED, .layers = layers});
+    }
+}
+
+// Reads the `keylog` lines of the console output. Each dump starts with the time of its first
+// entry, which wraps at 32 bits; dumps more than 71 minutes apart come out too close.
+static void read_console(FILE *file, events_t *events) {
+    char     line[256];
+    uint32_t raw   = 0; // the keyboard's time of the last entry
+    uint64_t time  = START_TIME;
+    bool     first = true; // the next entry is the first of a dump
+    while (fgets(line, sizeof(line), file)) {
+        char         *log = strstr(line, "keylog ");
+        unsigned long begin;
+        unsigned      dropped;
+        if (!log) {
+            continue;
+        }
+        if (sscanf(log, "keylog begin %lx %u", &begin, &dropped) == 2) {
+            if (events->dumps++) {
+                time += (uint32_t)((uint32_t)begin - raw);
+            }
+            raw = begin;
+            first = true;
+            events->dropped += dropped;
+            continue;
+        }
+        if (strncmp(log, "keylog end", 10) == 0 || !events->dumps) {
+            continue;
+        }
+        for (char *word = strtok(log + 7, " \t\r\n"); word; word = strtok(NULL, " \t\r\n")) {
+            char         *end;
+            unsigned long value = strtoul(word, &end, 16);
+            if (*end != '\0' || end - word != 8) {
+                break; // a line garbled by other console output
+            }
+            uint16_t delta = value >> 16;
+            uint8_t  key = value >> 8, layers = value;
+            if (!first) {
+                raw += advance(delta, key);
+                time += advance(delta, key);
+            }
+            first = false;
+            add_entry(events, time, key, layers);
+        }
+    }
+}
+
+static uint32_t read_le(const uint8_t *bytes, uint8_t size) {
+    uint32_t value = 0;
+    for (uint8_t i = size; i-- > 0;) {
+        value = value << 8 | bytes[i];
+    }
+    return value;
+}
+
+static void read_binary(const uint8_t *data, size_t size, const char *file_name, events_t *events) {
+    uint32_t count = read_le(data + 4, 4);
+    uint64_t time  = read_le(data + 8, 4) | (uint64_t)read_le(data + 12, 4) << 32;
+    if (size != HEADER_SIZE + (uint64_t)count * 4) {
+        fprintf(stderr, "keylog: %s: truncated trace\n", file_name);
+        exit(1);
+    }
+    for (const uint8_t *entry = data + HEADER_SIZE; entry < data + size; entry += 4) {
+        time += advance(read_le(entry, 2), entry[2]);
+        add_entry(events, time, entry[2], entry[3]);
+    }
+    events->dumps = 1;
+}
+
+static void read_input(FILE *file, const char *file_name, events_t *events) {
+    uint8_t *data = NULL;
+    size_t   size = 0, capacity = 0, length;
+    do {
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : 65536;
+            data     = realloc(data, capacity);
+            if (!data) {
+                perror("keylog");
+                exit(1);
+            }
+        }
+        length = fread(data + size, 1, capacity - size, file);
+        size += length;
+    } while (length);
+    if (size >= HEADER_SIZE && memcmp(data, MAGIC, 4) == 0) {
+        read_binary(data, size, file_name, events);
+    } else {
+        FILE *text = fmemopen(data, size ? size : 1, "r");
+        read_console(text, events);
+        fclose(text);
+    }
+    free(data);
+}
+
+static void put_entry(FILE *file, uint16_t delta, uint8_t key, uint8_t layers) {
+    uint8_t entry[4] = {delta, delta >> 8, key, layers};
+    fwrite(entry, 1, sizeof(entry), file);
+}
+
+static void write_binary(FILE *file, const events_t *events) {
+    uint8_t  header[HEADER_SIZE] = MAGIC;
+    uint64_t start               = events->count ? events->events[0].time : 0;
+    uint32_t count               = 0;
+    for (int pass = 0; pass < 2; pass++) { // counts the entries, then writes them
+        if (pass) {
+            for (uint8_t i = 0; i < 4; i++) {
+                header[4 + i] = count >> (i * 8);
+            }
+            for (uint8_t i = 0; i < 8; i++) {
+                header[8 + i] = start >> (i * 8);
+            }
+            fwrite(header, 1, sizeof(header), file);
+        }
+        for (size_t i = 0; i < events->count; i++) {
+            const event_t *event   = &events->events[i];
+            uint64_t       elapsed = event->time - (i ? events->events[i - 1].time : start);
+            while (elapsed > UINT16_MAX) {
+                uint16_t gap = elapsed >> 16 > UINT16_MAX ? UINT16_MAX : elapsed >> 16;
+                if (pass) put_entry(file, gap, KEYLOG_GAP, event->layers);
+                count += !pass;
+                elapsed -= (uint64_t)gap << 16;
+            }
+            if (pass) put_entry(file, elapsed, event->key | (event->pressed ? KEYLOG_PRESSED : 0), event->layers);
+            count += !pass;
+        }
+    }
+}
+
+// The keycode the key had under the recorded layers.
+static uint16_t keycode_of(const event_t *event) {
+    for (int8_t layer = 7; layer >= 0; layer--) {
+        if ((event->layers & (1 << layer)) && layer < sim_layer_count()) {
+            uint16_t keycode = sim_keycode_at(layer, event->key >> 4, event->key & 0x0F);
+            if (keycode != KC_TRNS) {
+                return keycode;
+            }
+        }
+    }
+    return sim_keycode_at(0, event->key >> 4, event->key & 0x0F);
+}
+
+static void print_events(const events_t *events) {
+    for (size_t i = 0; i < events->count; i++) {
+        const event_t *event = &events->events[i];
+        printf("%12.3f ms  %-4s %-2s  layers %02X  %s\n", (event->time - events->events[0].time) / 1e3, event->pressed ? "down" : "up", sim_position_name(event->key >> 4, event->key & 0x0F), event->layers, sim_keycode_name(keycode_of(event)));
+    }
+}
+
+static void print_replay(const events_t *events) {
+    for (size_t i = 0; i < events->count; i++) {
+        const event_t *event = &events->events[i];
+        printf("trace %08lX %u %02X %04X\n", (unsigned long)(uint32_t)event->time, !event->pressed, event->key, keycode_of(event));
+    }
+}
+
+static void print_simulate(const events_t *events) {
+    printf("scenario keylog\n");
+    for (size_t i = 0; i < events->count; i++) {
+        const event_t *event = &events->events[i];
+        printf("%-9g %-4s %s\n", (event->time - events->events[0].time) / 1e3, event->pressed ? "down" : "up", sim_position_name(event->key >> 4, event->key & 0x0F));
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: keylog [options] [console.txt|trace.bin]\n"
+            "  -o, --output FILE      write a binary trace\n"
+            "  -r, --replay           print the events as a trace for `replay`\n"
+            "  -s, --simulate         print the events as a script for `simulate`\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"output", required_argument, NULL, 'o'},
+        {"replay", no_argument, NULL, 'r'},
+        {"simulate", no_argument, NULL, 's'},
+        {NULL, 0, NULL, 0},
+    };
+    const char *output = NULL;
+    bool        replay = false, simulate = false;
+    int         option;
+    while ((option = getopt_long(argc, argv, "o:rs", options, NULL)) != -1) {
+        switch (option) {
+            // clang-format off
+            case 'o': output = optarg; break;
+            case 'r': replay = true; break;
+            case 's': simulate = true; break;
+            default: usage();
+            // clang-format on
+        }
+    }
+    if (argc - optind > 1 || (output != NULL) + replay + simulate > 1) {
+        usage();
+    }
+    const char *input = optind < argc ? argv[optind] : "stdin";
+    FILE       *file  = optind < argc ? fopen(input, "rb") : stdin;
+    if (!file) {
+        fprintf(stderr, "keylog: %s: %s\n", input, strerror(errno));
+        return 1;
+    }
+    events_t events = {0};
+    read_input(file, input, &events);
+    if (events.count == 0) {
+        fprintf(stderr, "keylog: %s: no key events\n", input);
+        return 1;
+    }
+    fprintf(stderr, "%zu key events over %.1f s from %zu dump(s), %zu entries were overwritten before a dump\n", events.count, (events.events[events.count - 1].time - events.events[0].time) / 1e6, events.dumps, events.dropped);
+
+    if (output) {
+        FILE *trace = fopen(output, "wb");
+        if (!trace) {
+            fprintf(stderr, "keylog: %s: %s\n", output, strerror(errno));
+            return 1;
+        }
+        write_binary(trace, &events);
+        if (fclose(trace) != 0) {
+            fprintf(stderr, "keylog: %s: %s\n", output, strerror(errno));
+            return 1;
+        }
+    } else if (replay) {
+        print_replay(&events);
+    } else if (simulate) {
+        print_simulate(&events);
+    } else {
+        print_events(&events);
+    }
+    return 0;
+}
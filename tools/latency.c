@@ -0,0 +1,344 @@
+// Measures the delay between a physical key press and the report that sends its key to the host,
+// over a set of standard scenarios built from the keymap's base layer:
+//
+//   tap        every key tapped on its own
+//   roll-same  two keys of the same hand rolled (the second pressed before the first is released)
+//   roll-cross the same with one key of each hand
+//   combo      the combos of the base layer, keys pressed 10 ms apart
+//   mod-tap    a mod-tap held while a key of the other hand is tapped (e.g. a shortcut)
+//   tap-dance  every tap dance tapped once, on its layer (the base layer's key to the layer held)
+//
+//   build/puq/latency [options]
+//
+// The options change the settings like those of `replay`, so that their cost can be compared.
+// For each measured press, the latency is the time until the first report with a new key (not a
+// modifier) that no earlier press got. Presses without such a report count as "no output".
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+
+#define START_TIME 100000   // µs, the keyboard has been running for a while
+#define SETTLE_TIME 1000000 // µs after the last event, so that every pending decision times out
+#define MAX_EVENTS 8
+
+typedef enum { TAP, ROLL_SAME, ROLL_CROSS, COMBO, MOD_TAP, TAP_DANCE, CATEGORY_COUNT } category_t;
+
+static const char *category_names[] = {"tap", "roll-same", "roll-cross", "combo", "mod-tap", "tap-dance"};
+
+typedef struct {
+    uint32_t time; // µs since the start of the scenario
+    uint8_t  row, col;
+    bool     pressed;
+    bool     measure;
+} event_t;
+
+typedef struct {
+    event_t events[MAX_EVENTS];
+    uint8_t count;
+} scenario_t;
+
+typedef struct {
+    uint32_t *values; // µs
+    size_t    count, capacity;
+    size_t    missing;
+} samples_t;
+
+// Outputs of one run: the times of the reports that added keys (one entry per new key).
+typedef struct {
+    uint64_t outputs[64];
+    uint8_t  count;
+    uint8_t  previous_keys[32];
+} run_t;
+
+static samples_t samples[CATEGORY_COUNT];
+static size_t    unreachable_tap_dances; // on layers without a layer key on the base layer
+
+static void add_sample(samples_t *samples, uint32_t value) {
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity ? samples->capacity * 2 : 256;
+        samples->values   = realloc(samples->values, samples->capacity * sizeof(uint32_t));
+        if (!samples->values) {
+            perror("latency");
+            exit(1);
+        }
+    }
+    samples->values[samples->count++] = value;
+}
+
+static void on_report(const sim_report_t *report, void *context) {
+    run_t *run = context;
+    for (uint16_t usage = KC_A; usage < KC_LEFT_CTRL; usage++) {
+        bool now = report->keys[usage >> 3] & (1 << (usage & 7)), before = run->previous_keys[usage >> 3] & (1 << (usage & 7));
+        if (now && !before && run->count < ARRAY_SIZE(run->outputs)) {
+            run->outputs[run->count++] = report->time;
+        }
+    }
+    memcpy(run->previous_keys, report->keys, sizeof(run->previous_keys));
+}
+
+static void on_console(const char *text, void *context) {}
+
+static void run_scenario(const scenario_t *scenario, category_t category) {
+    run_t run     = {0};
+    sim_callbacks = (sim_callbacks_t){.report = on_report, .console = on_console, .context = &run};
+    sim_reset();
+    sim_run_until(START_TIME);
+    uint64_t start = sim_now();
+    for (uint8_t i = 0; i < scenario->count; i++) {
+        sim_run_until(start + scenario->events[i].time);
+        sim_key(scenario->events[i].row, scenario->events[i].col, scenario->events[i].pressed);
+    }
+    sim_run_until(sim_now() + SETTLE_TIME);
+
+    uint8_t next = 0; // first output not taken by a measured press
+    for (uint8_t i = 0; i < scenario->count; i++) {
+        const event_t *event = &scenario->events[i];
+        if (!event->measure) {
+            continue;
+        }
+        uint64_t pressed = start + event->time;
+        while (next < run.count && run.outputs[next] < pressed) {
+            next++;
+        }
+        if (next < run.count) {
+            add_sample(&samples[category], run.outputs[next++] - pressed);
+        } else {
+            samples[category].missing++;
+        }
+    }
+}
+
+static bool is_left(uint8_t row, uint8_t col) {
+    return row < 3 || (row == 3 && (col == 1 || col == 3));
+}
+
+static bool is_thumb(uint8_t row) {
+    return row == 3;
+}
+
+// Keys of the base layer that send something on a tap.
+static bool is_tappable(uint16_t keycode) {
+    return (IS_QK_BASIC(keycode) && keycode >= KC_A && !IS_MODIFIER_KEYCODE(keycode)) || IS_QK_MODS(keycode) || IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+static bool find_position(uint16_t keycode, uint8_t *row, uint8_t *col) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            if (sim_keycode_at(0, r, c) == keycode) {
+                *row = r;
+                *col = c;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void add_event(scenario_t *scenario, uint32_t ms, uint8_t row, uint8_t col, bool pressed, bool measure) {
+    scenario->events[scenario->count++] = (event_t){.time = ms * 1000, .row = row, .col = col, .pressed = pressed, .measure = measure};
+}
+
+// A key of the base layer that turns `layer` on while held (MO or LT), other than the given one.
+static bool find_layer_key(uint8_t layer, uint8_t not_row, uint8_t not_col, uint8_t *row, uint8_t *col) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            uint16_t keycode = sim_keycode_at(0, r, c);
+            bool     match   = (IS_QK_MOMENTARY(keycode) && QK_MOMENTARY_GET_LAYER(keycode) == layer) || (IS_QK_LAYER_TAP(keycode) && QK_LAYER_TAP_GET_LAYER(keycode) == layer);
+            if (match && (r != not_row || c != not_col)) {
+                *row = r;
+                *col = c;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void run_tap_dances(void) {
+    uint32_t hold = 2 * sim_settings.tapping_term; // ms, the layer key is held when the dance starts
+    for (uint8_t layer = 0; layer < sim_layer_count(); layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (!IS_QK_TAP_DANCE(sim_keycode_at(layer, row, col))) {
+                    continue;
+                }
+                scenario_t scenario = {0};
+                if (layer == 0) {
+                    add_event(&scenario, 0, row, col, true, true);
+                    add_event(&scenario, 40, row, col, false, false);
+                    run_scenario(&scenario, TAP_DANCE);
+                    continue;
+                }
+                uint8_t layer_row, layer_col;
+                if (!find_layer_key(layer, row, col, &layer_row, &layer_col)) {
+                    unreachable_tap_dances++;
+                    continue;
+                }
+                add_event(&scenario, 0, layer_row, layer_col, true, false);
+                add_event(&scenario, hold, row, col, true, true);
+                add_event(&scenario, hold + 40, row, col, false, false);
+                add_event(&scenario, hold + 100, layer_row, layer_col, false, false);
+                run_scenario(&scenario, TAP_DANCE);
+            }
+        }
+    }
+}
+
+static void run_all(void) {
+    for (uint8_t a = 0; a < MATRIX_ROWS * MATRIX_COLS; a++) {
+        uint8_t  row_a = a / MATRIX_COLS, col_a = a % MATRIX_COLS;
+        uint16_t keycode_a = sim_keycode_at(0, row_a, col_a);
+        if (!is_tappable(keycode_a)) {
+            continue;
+        }
+        scenario_t tap = {0};
+        add_event(&tap, 0, row_a, col_a, true, true);
+        add_event(&tap, 40, row_a, col_a, false, false);
+        run_scenario(&tap, TAP);
+
+        for (uint8_t b = 0; b < MATRIX_ROWS * MATRIX_COLS; b++) {
+            uint8_t  row_b = b / MATRIX_COLS, col_b = b % MATRIX_COLS;
+            uint16_t keycode_b = sim_keycode_at(0, row_b, col_b);
+            if (a == b || !is_tappable(keycode_b) || is_thumb(row_a) || is_thumb(row_b)) {
+                continue;
+            }
+            bool       same = is_left(row_a, col_a) == is_left(row_b, col_b);
+            scenario_t roll = {0};
+            add_event(&roll, 0, row_a, col_a, true, true);
+            add_event(&roll, 60, row_b, col_b, true, true);
+            add_event(&roll, 90, row_a, col_a, false, false);
+            add_event(&roll, 140, row_b, col_b, false, false);
+            run_scenario(&roll, same ? ROLL_SAME : ROLL_CROSS);
+
+            if (!same && IS_QK_MOD_TAP(keycode_a) && !IS_QK_MOD_TAP(keycode_b) && !IS_QK_LAYER_TAP(keycode_b)) {
+                scenario_t shortcut = {0};
+                add_event(&shortcut, 0, row_a, col_a, true, false);
+                add_event(&shortcut, 300, row_b, col_b, true, true);
+                add_event(&shortcut, 340, row_b, col_b, false, false);
+                add_event(&shortcut, 400, row_a, col_a, false, false);
+                run_scenario(&shortcut, MOD_TAP);
+            }
+        }
+    }
+
+#ifdef COMBO_ENABLE
+    for (uint16_t index = 0; index < sim_combo_count(); index++) {
+        scenario_t scenario = {0};
+        uint8_t    rows[MAX_EVENTS / 2], cols[MAX_EVENTS / 2], count = 0;
+        uint16_t   keycode;
+        bool       found = true;
+        while ((keycode = pgm_read_word(&key_combos[index].keys[count])) != COMBO_END && count < ARRAY_SIZE(rows)) {
+            found &= find_position(keycode, &rows[count], &cols[count]);
+            count++;
+        }
+        if (!found || !is_tappable(key_combos[index].keycode)) {
+            continue; // a combo of another layer, or one that does not type anything
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            add_event(&scenario, i * 10, rows[i], cols[i], true, i == count - 1);
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            add_event(&scenario, 80 + i * 10, rows[i], cols[i], false, false);
+        }
+        run_scenario(&scenario, COMBO);
+    }
+#endif
+    run_tap_dances();
+}
+
+static int compare_values(const void *a, const void *b) {
+    uint32_t first = *(const uint32_t *)a, second = *(const uint32_t *)b;
+    return first < second ? -1 : first > second;
+}
+
+static double percentile(const samples_t *samples, unsigned percent) {
+    return samples->values[(samples->count - 1) * percent / 100] / 1e3;
+}
+
+static int parse_toggle(const char *value) {
+    if (strcmp(value, "on") == 0) return true;
+    if (strcmp(value, "off") == 0) return false;
+    if (strcmp(value, "keymap") == 0) return SIM_KEYMAP;
+    fprintf(stderr, "latency: expected on, off or keymap instead of '%s'\n", value);
+    exit(2);
+}
+
+static unsigned parse_number(const char *value) {
+    char         *end;
+    unsigned long number = strtoul(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || number > 0xFFFF) {
+        fprintf(stderr, "latency: invalid number '%s'\n", value);
+        exit(2);
+    }
+    return number;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: latency [options]\n"
+            "  --tapping-term MS\n"
+            "  --quick-tap-term MS\n"
+            "  --combo-term MS\n"
+            "  --combo-hold-term MS\n"
+            "  --permissive-hold on|off|keymap\n"
+            "  --hold-on-other-key-press on|off|keymap\n"
+            "  --scan-interval US     time between two matrix scans (default 500)\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"tapping-term", required_argument, NULL, 't'},
+        {"quick-tap-term", required_argument, NULL, 'q'},
+        {"combo-term", required_argument, NULL, 'c'},
+        {"combo-hold-term", required_argument, NULL, 'C'},
+        {"permissive-hold", required_argument, NULL, 'p'},
+        {"hold-on-other-key-press", required_argument, NULL, 'o'},
+        {"scan-interval", required_argument, NULL, 's'},
+        {NULL, 0, NULL, 0},
+    };
+    sim_default_settings();
+    int option;
+    while ((option = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        switch (option) {
+            // clang-format off
+            case 't': sim_settings.tapping_term = parse_number(optarg); break;
+            case 'q': sim_settings.quick_tap_term = parse_number(optarg); break;
+            case 'c': sim_settings.combo_term = parse_number(optarg); break;
+            case 'C': sim_settings.combo_hold_term = parse_number(optarg); break;
+            case 'p': sim_settings.permissive_hold = parse_toggle(optarg); break;
+            case 'o': sim_settings.hold_on_other_key_press = parse_toggle(optarg); break;
+            case 's': sim_settings.scan_interval = parse_number(optarg); break;
+            default: usage();
+            // clang-format on
+        }
+    }
+    if (optind != argc) {
+        usage();
+    }
+
+    run_all();
+
+    printf("%-11s %7s %8s %8s %8s %8s %8s %10s\n", "scenario", "presses", "min ms", "median", "p90", "p99", "max", "no output");
+    for (category_t category = 0; category < CATEGORY_COUNT; category++) {
+        samples_t *category_samples = &samples[category];
+        if (!category_samples->count) {
+            if (category_samples->missing) {
+                printf("%-11s %7zu %8s %8s %8s %8s %8s %10zu\n", category_names[category], category_samples->missing, "-", "-", "-", "-", "-", category_samples->missing);
+            }
+            continue;
+        }
+        qsort(category_samples->values, category_samples->count, sizeof(uint32_t), compare_values);
+        printf("%-11s %7zu %8.1f %8.1f %8.1f %8.1f %8.1f %10zu\n", category_names[category], category_samples->count + category_samples->missing, category_samples->values[0] / 1e3, percentile(category_samples, 50), percentile(category_samples, 90), percentile(category_samples, 99), category_samples->values[category_samples->count - 1] / 1e3, category_samples->missing);
+    }
+    if (!samples[TAP_DANCE].count && !samples[TAP_DANCE].missing) {
+        printf("No tap dances found in the keymap.\n");
+    }
+    if (unreachable_tap_dances) {
+        printf("Not measured: %zu tap dances on layers without a layer key on the base layer.\n", unreachable_tap_dances);
+    }
+    return 0;
+}
@@ -0,0 +1,326 @@
+// Replays a trace recorded with TRACE_ENABLE (see features/trace.h) through the keymap compiled
+// for the host, once with the keymap's settings and once with the settings given on the command
+// line, and lists the presses that would have been resolved differently.
+//
+//   build/puq/replay [options] [trace.txt]
+//
+// The trace is read from the console output of the keyboard (`qmk console > trace.txt`), other
+// lines are ignored. Without a file name it is read from stdin.
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+
+#define START_TIME 100000 // µs, the keyboard has been running for a while when the trace starts
+
+typedef struct {
+    uint64_t time; // µs since the start of the trace
+    uint8_t  kind; // trace_kind_t
+    uint8_t  key;
+    uint16_t keycode;
+} event_t;
+
+typedef struct {
+    event_t *events;
+    size_t   count, capacity;
+} events_t;
+
+typedef struct {
+    events_t  decisions; // as trace entries, so that they compare with the recorded ones
+    char    **outcomes;  // per press, NULL for presses without a decision
+    size_t    presses;
+    char     *typed;     // the host's view, as a space separated list of key presses
+    size_t    typed_length, typed_capacity;
+    uint8_t   previous_keys[32];
+    uint16_t  previous_consumer;
+    uint8_t   previous_mouse;
+} run_t;
+
+static const char *kind_names[] = {"press", "release", "tap", "hold", "combo", "tap-dance"};
+
+static void push_event(events_t *events, event_t event) {
+    if (events->count == events->capacity) {
+        events->capacity = events->capacity ? events->capacity * 2 : 256;
+        events->events   = realloc(events->events, events->capacity * sizeof(event_t));
+        if (!events->events) {
+            perror("replay");
+            exit(1);
+        }
+    }
+    events->events[events->count++] = event;
+}
+
+// Reads all `trace` lines of the console output. Timestamps wrap at 32 bits.
+static void read_trace(FILE *file, events_t *events, char *header, size_t header_size) {
+    char     line[256];
+    uint32_t previous = 0;
+    uint64_t time     = START_TIME;
+    bool     first    = true;
+    while (fgets(line, sizeof(line), file)) {
+        char *trace = strstr(line, "trace ");
+        if (!trace) {
+            continue;
+        }
+        unsigned long raw_time;
+        unsigned      kind, key, keycode;
+        if (strncmp(trace, "trace begin", 11) == 0) {
+            snprintf(header, header_size, "%s", trace + 6);
+            header[strcspn(header, "\r\n")] = '\0';
+        } else if (sscanf(trace, "trace %lx %u %x %x", &raw_time, &kind, &key, &keycode) == 4 && kind < ARRAY_SIZE(kind_names)) {
+            if (!first) {
+                time += (uint32_t)((uint32_t)raw_time - previous);
+            }
+            previous = raw_time;
+            first    = false;
+            push_event(events, (event_t){.time = time, .kind = kind, .key = key, .keycode = keycode});
+        }
+    }
+}
+
+static void append_typed(run_t *run, const char *token) {
+    size_t length = strlen(token) + 1;
+    if (run->typed_length + length + 1 > run->typed_capacity) {
+        run->typed_capacity = (run->typed_capacity + length) * 2;
+        run->typed          = realloc(run->typed, run->typed_capacity);
+    }
+    if (run->typed_length) {
+        run->typed[run->typed_length++] = ' ';
+    }
+    memcpy(run->typed + run->typed_length, token, length);
+    run->typed_length += length - 1;
+}
+
+// Every newly pressed key becomes a token like "S-KC_A" (modifiers without left/right).
+static void on_report(const sim_report_t *report, void *context) {
+    run_t *run = context;
+    char   token[64];
+    for (uint16_t usage = KC_A; usage < 256; usage++) {
+        bool now = report->keys[usage >> 3] & (1 << (usage & 7)), before = run->previous_keys[usage >> 3] & (1 << (usage & 7));
+        if (now && !before) {
+            uint8_t mods = (report->mods | report->mods >> 4) & 0x0F;
+            snprintf(token, sizeof(token), "%s%s%s%s%s", mods & 1 ? "C-" : "", mods & 2 ? "S-" : "", mods & 4 ? "A-" : "", mods & 8 ? "G-" : "", sim_keycode_name(usage));
+            append_typed(run, token);
+        }
+    }
+    if (report->consumer && report->consumer != run->previous_consumer) {
+        snprintf(token, sizeof(token), "consumer:%04X", report->consumer);
+        append_typed(run, token);
+    }
+    for (uint8_t button = 0; button < 5; button++) {
+        if ((report->mouse & ~run->previous_mouse) & (1 << button)) {
+            snprintf(token, sizeof(token), "BTN%u", button + 1);
+            append_typed(run, token);
+        }
+    }
+    memcpy(run->previous_keys, report->keys, sizeof(run->previous_keys));
+    run->previous_consumer = report->consumer;
+    run->previous_mouse    = report->mouse;
+}
+
+static void on_decision(const sim_decision_t *decision, void *context) {
+    run_t  *run     = context;
+    uint8_t key     = decision->key.row << 4 | decision->key.col;
+    uint8_t kinds[] = {[SIM_TAP] = 2, [SIM_HOLD] = 3, [SIM_COMBO] = 4, [SIM_TAP_DANCE] = 5};
+    char    outcome[80];
+    switch (decision->kind) {
+        case SIM_COMBO:
+            push_event(&run->decisions, (event_t){.time = decision->time, .kind = kinds[decision->kind], .key = 0xFF, .keycode = decision->keycode});
+            snprintf(outcome, sizeof(outcome), "combo %s", sim_keycode_name(decision->keycode));
+            break;
+        case SIM_TAP_DANCE:
+            push_event(&run->decisions, (event_t){.time = decision->time, .kind = kinds[decision->kind], .key = decision->data, .keycode = decision->keycode});
+            snprintf(outcome, sizeof(outcome), "%s %u tap(s)%s%s", sim_keycode_name(decision->keycode), decision->data & 0x0F, decision->data & 0x80 ? " held" : "", decision->data & 0x40 ? " interrupted" : "");
+            break;
+        default:
+            push_event(&run->decisions, (event_t){.time = decision->time, .kind = kinds[decision->kind], .key = key, .keycode = decision->keycode});
+            snprintf(outcome, sizeof(outcome), "%s", decision->kind == SIM_TAP ? "tap" : "hold");
+            break;
+    }
+    if (decision->press && decision->press <= run->presses && !run->outcomes[decision->press - 1]) {
+        run->outcomes[decision->press - 1] = strdup(outcome);
+    }
+}
+
+static void on_console(const char *text, void *context) {}
+
+static size_t count_presses(const events_t *trace) {
+    size_t presses = 0;
+    for (size_t i = 0; i < trace->count; i++) {
+        presses += trace->events[i].kind == 0;
+    }
+    return presses;
+}
+
+static void run_trace(const events_t *trace, run_t *run) {
+    memset(run, 0, sizeof(*run));
+    run->presses  = count_presses(trace);
+    run->outcomes = calloc(run->presses + 1, sizeof(char *));
+    append_typed(run, "");
+    sim_callbacks = (sim_callbacks_t){.report = on_report, .decision = on_decision, .console = on_console, .context = run};
+    sim_reset();
+    for (size_t i = 0; i < trace->count; i++) {
+        const event_t *event = &trace->events[i];
+        if (event->kind > 1 || event->key == 0xFF) {
+            continue;
+        }
+        sim_run_until(event->time);
+        sim_key(event->key >> 4, event->key & 0x0F, event->kind == 0);
+    }
+    sim_run_until(sim_now() + 5000000); // let every pending decision time out
+}
+
+// Length of the longest common subsequence of two decision lists.
+static size_t common_decisions(const events_t *a, const events_t *b) {
+    size_t *row = calloc(b->count + 1, sizeof(size_t));
+    for (size_t i = 0; i < a->count; i++) {
+        size_t diagonal = 0;
+        for (size_t j = 0; j < b->count; j++) {
+            size_t above = row[j + 1];
+            bool   equal = a->events[i].kind == b->events[j].kind && a->events[i].key == b->events[j].key && a->events[i].keycode == b->events[j].keycode;
+            row[j + 1]   = equal ? diagonal + 1 : (row[j] > above ? row[j] : above);
+            diagonal     = above;
+        }
+    }
+    size_t length = row[b->count];
+    free(row);
+    return length;
+}
+
+static int parse_toggle(const char *value) {
+    if (strcmp(value, "on") == 0) return true;
+    if (strcmp(value, "off") == 0) return false;
+    if (strcmp(value, "keymap") == 0) return SIM_KEYMAP;
+    fprintf(stderr, "replay: expected on, off or keymap instead of '%s'\n", value);
+    exit(2);
+}
+
+static unsigned parse_number(const char *value) {
+    char         *end;
+    unsigned long number = strtoul(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || number > 0xFFFF) {
+        fprintf(stderr, "replay: invalid number '%s'\n", value);
+        exit(2);
+    }
+    return number;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: replay [options] [trace.txt]\n"
+            "  --tapping-term MS\n"
+            "  --quick-tap-term MS\n"
+            "  --combo-term MS\n"
+            "  --combo-hold-term MS\n"
+            "  --permissive-hold on|off|keymap\n"
+            "  --hold-on-other-key-press on|off|keymap\n"
+            "  --scan-interval US     time between two matrix scans (default 500)\n"
+            "  -v, --verbose          list the outcome of every press\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"tapping-term", required_argument, NULL, 't'},
+        {"quick-tap-term", required_argument, NULL, 'q'},
+        {"combo-term", required_argument, NULL, 'c'},
+        {"combo-hold-term", required_argument, NULL, 'C'},
+        {"permissive-hold", required_argument, NULL, 'p'},
+        {"hold-on-other-key-press", required_argument, NULL, 'o'},
+        {"scan-interval", required_argument, NULL, 's'},
+        {"verbose", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0},
+    };
+    sim_default_settings();
+    sim_settings_t keymap_settings = sim_settings, settings = sim_settings;
+    bool           verbose = false;
+    int            option;
+    while ((option = getopt_long(argc, argv, "v", options, NULL)) != -1) {
+        switch (option) {
+            // clang-format off
+            case 't': settings.tapping_term = parse_number(optarg); break;
+            case 'q': settings.quick_tap_term = parse_number(optarg); break;
+            case 'c': settings.combo_term = parse_number(optarg); break;
+            case 'C': settings.combo_hold_term = parse_number(optarg); break;
+            case 'p': settings.permissive_hold = parse_toggle(optarg); break;
+            case 'o': settings.hold_on_other_key_press = parse_toggle(optarg); break;
+            case 's': settings.scan_interval = keymap_settings.scan_interval = parse_number(optarg); break;
+            case 'v': verbose = true; break;
+            default: usage();
+            // clang-format on
+        }
+    }
+    if (argc - optind > 1) {
+        usage();
+    }
+    FILE *file = optind < argc ? fopen(argv[optind], "r") : stdin;
+    if (!file) {
+        fprintf(stderr, "replay: %s: %s\n", argv[optind], strerror(errno));
+        return 1;
+    }
+
+    events_t trace       = {0};
+    events_t recorded    = {0};
+    char     header[128] = "";
+    read_trace(file, &trace, header, sizeof(header));
+    for (size_t i = 0; i < trace.count; i++) {
+        if (trace.events[i].kind > 1) {
+            push_event(&recorded, trace.events[i]);
+        }
+    }
+    if (count_presses(&trace) == 0) {
+        fprintf(stderr, "replay: no key presses in the trace\n");
+        return 1;
+    }
+    printf("trace: %zu presses over %.1f s%s%s\n", count_presses(&trace), (trace.events[trace.count - 1].time - START_TIME) / 1e6, *header ? ", " : "", header);
+
+    run_t baseline, alternative;
+    sim_settings = keymap_settings;
+    run_trace(&trace, &baseline);
+
+    // The model has to agree with the keyboard before its predictions mean anything.
+    if (recorded.count) {
+        events_t comparable = {0};
+        bool     tap_dance  = false;
+        for (size_t i = 0; i < recorded.count; i++) {
+            tap_dance |= recorded.events[i].kind == 5;
+        }
+        for (size_t i = 0; i < baseline.decisions.count; i++) {
+            if (baseline.decisions.events[i].kind != 5 || tap_dance) {
+                push_event(&comparable, baseline.decisions.events[i]);
+            }
+        }
+        size_t common = common_decisions(&recorded, &comparable);
+        printf("model: reproduces %zu of %zu recorded decisions (%zu predicted)\n", common, recorded.count, comparable.count);
+    }
+
+    sim_settings = settings;
+    run_trace(&trace, &alternative);
+    printf("settings: tapping_term %u -> %u, quick_tap_term %u -> %u, combo_term %u -> %u, permissive_hold %s, hold_on_other_key_press %s\n", keymap_settings.tapping_term, settings.tapping_term, keymap_settings.quick_tap_term, settings.quick_tap_term, keymap_settings.combo_term, settings.combo_term, settings.permissive_hold == SIM_KEYMAP ? "as keymap" : settings.permissive_hold ? "on" : "off", settings.hold_on_other_key_press == SIM_KEYMAP ? "as keymap" : settings.hold_on_other_key_press ? "on" : "off");
+
+    size_t press = 0, changed = 0;
+    for (size_t i = 0; i < trace.count; i++) {
+        const event_t *event = &trace.events[i];
+        if (event->kind != 0) {
+            continue;
+        }
+        const char *before = baseline.outcomes[press] ? baseline.outcomes[press] : "plain";
+        const char *after  = alternative.outcomes[press] ? alternative.outcomes[press] : "plain";
+        bool        differ = strcmp(before, after) != 0;
+        changed += differ;
+        if (differ || verbose) {
+            uint16_t keycode = event->keycode ? event->keycode : sim_keycode_at(0, event->key >> 4, event->key & 0x0F);
+            printf("press %4zu  %9.3f s  row %u col %u  %-24s  %s%s%s\n", press + 1, (event->time - START_TIME) / 1e6, event->key >> 4, event->key & 0x0F, sim_keycode_name(keycode), before, differ ? " -> " : "", differ ? after : "");
+        }
+        press++;
+    }
+    printf("changed: %zu of %zu presses\n", changed, press);
+    if (strcmp(baseline.typed, alternative.typed) != 0 || verbose) {
+        printf("typed before: %s\ntyped after:  %s\n", baseline.typed, alternative.typed);
+    } else {
+        printf("typed: unchanged\n");
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+# Builds the host tools for one keymap: `make -f sim.mk KEYMAP=puq`. The keymap is compiled with
+# the features and options of its rules.mk, like the QMK build does (see sim/sim.h).
+
+REPO := ..
+BUILD := build/$(KEYMAP)
+# The keymaps of the golden suite that only test a feature live in golden/keymaps/ instead:
+KEYMAP_DIR ?= $(REPO)/keymaps/$(KEYMAP)
+
+# Features enabled for the keyboard in info.json:
+EXTRAKEY_ENABLE = yes
+MOUSEKEY_ENABLE = yes
+NKRO_ENABLE = yes
+
+include $(KEYMAP_DIR)/rules.mk
+include $(REPO)/rules.mk
+include $(REPO)/post_rules.mk
+
+# Layout of the host the keymap's keycodes are meant for, e.g. for the characters of `corpus`:
+HOST_LAYOUT := $(if $(shell grep -l 'DE_' $(KEYMAP_DIR)/keymap.c),de,us)
+
+FEATURES := CAPS_WORD COMBO CONSOLE EXTRAKEY KEY_OVERRIDE MOUSEKEY NKRO REPEAT_KEY TAP_DANCE
+OPT_DEFS += $(foreach f,$(FEATURES),$(if $(filter yes,$(strip $($(f)_ENABLE))),-D$(f)_ENABLE))
+
+CC ?= cc
+CFLAGS ?= -O2 -g
+SIM_CFLAGS := -std=gnu11 -Wall -Wno-unused-function -Wno-unused-variable -Wno-unused-parameter \
+    -include $(REPO)/config.h -include $(KEYMAP_DIR)/config.h -include sim/include/sim_config.h \
+    -DQMK_KEYBOARD_H='"zilpzalp.h"' -DKEYMAP_C='"$(abspath $(KEYMAP_DIR)/keymap.c)"' -DPROTOCOL_CHIBIOS \
+    -DSIM_HOST_LAYOUT='"$(HOST_LAYOUT)"' \
+    -Isim/include -Isim -I$(REPO) -I$(KEYMAP_DIR) $(OPT_DEFS)
+
+SIM_SRC := $(wildcard sim/*.c) $(REPO)/zilpzalp.c $(addprefix $(REPO)/,$(SRC))
+SIM_OBJ := $(patsubst %.c,$(BUILD)/%.o,$(subst ../,,$(SIM_SRC)))
+TOOLS := corpus fuzz hwlatency keylog latency replay simulate strings sweep
+# Files that change the compiler flags (features, config), so everything is rebuilt with them:
+FLAG_DEPS := sim.mk $(REPO)/rules.mk $(REPO)/post_rules.mk $(REPO)/config.h $(KEYMAP_DIR)/rules.mk $(KEYMAP_DIR)/config.h
+
+# `corpus --check` types through the kernel into an XKB layout if libxkbcommon is installed:
+ifeq ($(shell pkg-config --exists xkbcommon && echo yes),yes)
+$(BUILD)/tools/corpus.o: SIM_CFLAGS += -DXKB_ENABLE $(shell pkg-config --cflags xkbcommon)
+$(BUILD)/corpus: LDFLAGS += $(shell pkg-config --libs xkbcommon)
+endif
+
+all: $(addprefix $(BUILD)/,$(TOOLS))
+
+$(BUILD)/%: $(BUILD)/tools/%.o $(SIM_OBJ)
+	$(CC) $(CFLAGS) -o $@ $^ $(LDFLAGS) -lm -pthread
+
+$(BUILD)/tools/%.o: %.c sim/sim.h $(FLAG_DEPS)
+	@mkdir -p $(dir $@)
+	$(CC) $(CFLAGS) $(SIM_CFLAGS) -MMD -c -o $@ $<
+
+$(BUILD)/sim/%.o: sim/%.c $(FLAG_DEPS)
+	@mkdir -p $(dir $@)
+	$(CC) $(CFLAGS) $(SIM_CFLAGS) -MMD -c -o $@ $<
+
+$(BUILD)/%.o: $(REPO)/%.c $(FLAG_DEPS)
+	@mkdir -p $(dir $@)
+	$(CC) $(CFLAGS) $(SIM_CFLAGS) -MMD -c -o $@ $<
+
+-include $(shell find $(BUILD) -name '*.d' 2>/dev/null)
+
+.PHONY: all
+.SECONDARY:
@@ -0,0 +1,336 @@
+// Combos, ported from QMK's process_combo.c (0.22) without the options none of the keymaps use
+// (COMBO_STRICT_TIMER, COMBO_NO_TIMER, COMBO_PROCESS_KEY_RELEASE, COMBO_SHOULD_TRIGGER, ...).
+
+#include "internal.h"
+
+#ifdef COMBO_ENABLE
+
+#    define COMBO_KEY_BUFFER_LENGTH 8
+#    define COMBO_BUFFER_LENGTH 4
+#    define COMBO_KEY_POS MAKE_KEYPOS(KEYLOC_COMBO, KEYLOC_COMBO)
+#    define INCREMENT_MOD(i) i = (i + 1) % COMBO_BUFFER_LENGTH
+
+#    define ALL_COMBO_KEYS_ARE_DOWN(state, key_count) (((1 << (key_count)) - 1) == (state))
+#    define ONLY_ONE_KEY_IS_DOWN(state) !((state) & ((state)-1))
+#    define KEY_NOT_YET_RELEASED(state, key_index) ((1 << (key_index)) & (state))
+
+typedef struct {
+    keyrecord_t record;
+    uint16_t    combo_index;
+    uint16_t    keycode;
+} queued_record_t;
+
+static uint16_t        timer;
+static uint16_t        longest_term;
+static queued_record_t key_buffer[COMBO_KEY_BUFFER_LENGTH];
+static uint8_t         key_buffer_size, key_buffer_next;
+static uint16_t        combo_buffer[COMBO_BUFFER_LENGTH];
+static uint8_t         combo_buffer_read, combo_buffer_write;
+
+__attribute__((weak)) uint16_t get_combo_term(uint16_t index, combo_t *combo) {
+    return COMBO_TERM;
+}
+
+__attribute__((weak)) bool get_combo_must_hold(uint16_t index, combo_t *combo) {
+    return false;
+}
+
+__attribute__((weak)) bool get_combo_must_tap(uint16_t index, combo_t *combo) {
+    return false;
+}
+
+__attribute__((weak)) void process_combo_event(uint16_t combo_index, bool pressed) {}
+
+static bool must_hold(uint16_t combo_index, combo_t *combo) {
+#    ifdef COMBO_MUST_HOLD_PER_COMBO
+    return get_combo_must_hold(combo_index, combo);
+#    elif defined(COMBO_MUST_HOLD_MODS)
+    return IS_MODIFIER_KEYCODE(combo->keycode) || IS_QK_MOMENTARY(combo->keycode);
+#    else
+    return false;
+#    endif
+}
+
+static bool must_tap(uint16_t combo_index, combo_t *combo) {
+#    ifdef COMBO_MUST_TAP_PER_COMBO
+    return get_combo_must_tap(combo_index, combo);
+#    else
+    return false;
+#    endif
+}
+
+static uint16_t combo_term(uint16_t combo_index, combo_t *combo) {
+#    ifdef COMBO_TERM_PER_COMBO
+    uint16_t term = get_combo_term(combo_index, combo);
+    return sim_settings.per_combo_term && term != COMBO_TERM ? sim_settings.per_combo_term : term;
+#    else
+    return COMBO_TERM;
+#    endif
+}
+
+static uint16_t wait_time(uint16_t combo_index, combo_t *combo) {
+    if ((must_hold(combo_index, combo) || must_tap(combo_index, combo)) && longest_term < COMBO_HOLD_TERM) {
+        return COMBO_HOLD_TERM;
+    }
+    return longest_term;
+}
+
+static void find_key_index_and_count(const uint16_t *keys, uint16_t keycode, int16_t *key_index, uint8_t *key_count) {
+    while (true) {
+        uint16_t key = pgm_read_word(&keys[*key_count]);
+        if (key == keycode) *key_index = *key_count;
+        if (key == COMBO_END) break;
+        (*key_count)++;
+    }
+}
+
+static void release_combo(uint16_t combo_index, combo_t *combo) {
+    if (combo->keycode) {
+        keyrecord_t record = {
+            .event   = {.key = COMBO_KEY_POS, .time = timer_read() | 1, .pressed = false, .type = COMBO_EVENT},
+            .keycode = combo->keycode,
+        };
+        action_tapping_process(record);
+    } else {
+        process_combo_event(combo_index, false);
+    }
+    combo->active = false;
+}
+
+static void clear_combos(void) {
+    longest_term = 0;
+    for (uint16_t index = 0; index < sim_combo_count(); index++) {
+        combo_t *combo = &key_combos[index];
+        if (!combo->active) {
+            combo->state    = 0;
+            combo->disabled = false;
+        }
+    }
+}
+
+static void dump_key_buffer(void) {
+    // Processing a record may recurse into process_combo(), so the position is kept across calls.
+    if (key_buffer_size == 0) {
+        return;
+    }
+    for (uint8_t i = key_buffer_next; i < key_buffer_size; i++) {
+        key_buffer_next          = i + 1;
+        queued_record_t *qrecord = &key_buffer[i];
+        keyrecord_t     *record  = &qrecord->record;
+        if (IS_NOEVENT(record->event)) {
+            continue;
+        }
+        if (!record->keycode && qrecord->combo_index != (uint16_t)-1) {
+            process_combo_event(qrecord->combo_index, true);
+        } else {
+            action_tapping_process(*record);
+        }
+        record->event.type = TICK_EVENT;
+    }
+    key_buffer_next = key_buffer_size = 0;
+}
+
+static void drop_combo_from_buffer(uint16_t combo_index) {
+    for (uint8_t i = combo_buffer_read; i != combo_buffer_write; INCREMENT_MOD(i)) {
+        if (combo_buffer[i] == combo_index) {
+            key_combos[combo_index].disabled = true;
+            if (i == combo_buffer_read) {
+                INCREMENT_MOD(combo_buffer_read);
+            }
+            combo_buffer[i] = (uint16_t)-1;
+            return;
+        }
+    }
+}
+
+// Turns the last buffered key of the combo into the combo's event and the others into ticks.
+static void apply_combo(uint16_t combo_index, combo_t *combo) {
+    if (combo->disabled) {
+        return;
+    }
+    uint32_t state = 0;
+    for (uint8_t i = 0; i < key_buffer_size; i++) {
+        queued_record_t *qrecord   = &key_buffer[i];
+        keyrecord_t     *record    = &qrecord->record;
+        uint8_t          key_count = 0;
+        int16_t          key_index = -1;
+        find_key_index_and_count(combo->keys, qrecord->keycode, &key_index, &key_count);
+        if (key_index == -1) {
+            continue;
+        }
+        state |= 1 << key_index;
+        if (ALL_COMBO_KEYS_ARE_DOWN(state, key_count)) {
+            sim_decide(SIM_COMBO, record->event.key, combo->keycode, combo_index);
+            record->keycode      = combo->keycode;
+            record->event.type   = COMBO_EVENT;
+            record->event.key    = COMBO_KEY_POS;
+            qrecord->combo_index = combo_index;
+            combo->active        = true;
+            break;
+        } else {
+            record->event.type = TICK_EVENT;
+        }
+    }
+    drop_combo_from_buffer(combo_index);
+}
+
+static void apply_combos(void) {
+    for (uint8_t i = combo_buffer_read; i != combo_buffer_write; INCREMENT_MOD(i)) {
+        uint16_t combo_index = combo_buffer[i];
+        if (combo_index == (uint16_t)-1) {
+            continue;
+        }
+        combo_t *combo = &key_combos[combo_index];
+        if (must_tap(combo_index, combo)) {
+            // tap-only combos are applied on key release only
+            drop_combo_from_buffer(combo_index);
+            continue;
+        }
+        apply_combo(combo_index, combo);
+    }
+    dump_key_buffer();
+    clear_combos();
+}
+
+// Returns the combo to drop if the two overlap: the one with fewer keys, or `combo1` on a draw.
+static combo_t *overlaps(combo_t *combo1, combo_t *combo2) {
+    uint8_t  idx1 = 0, idx2 = 0;
+    uint16_t key1, key2;
+    bool     overlap = false;
+    while ((key1 = pgm_read_word(&combo1->keys[idx1])) != COMBO_END) {
+        idx2 = 0;
+        while ((key2 = pgm_read_word(&combo2->keys[idx2])) != COMBO_END) {
+            if (key1 == key2) overlap = true;
+            idx2++;
+        }
+        idx1++;
+    }
+    if (!overlap) return NULL;
+    return idx2 < idx1 ? combo2 : combo1;
+}
+
+static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record, uint16_t combo_index) {
+    uint8_t key_count = 0;
+    int16_t key_index = -1;
+    find_key_index_and_count(combo->keys, keycode, &key_index, &key_count);
+    if (key_index == -1) {
+        return false;
+    }
+
+    bool key_is_part_of_combo = !combo->disabled;
+
+    if (record->event.pressed && key_is_part_of_combo) {
+        uint16_t time = combo_term(combo_index, combo);
+        if (!combo->active) {
+            combo->state |= 1 << key_index;
+            if (longest_term < time) {
+                longest_term = time;
+            }
+        }
+        if (ALL_COMBO_KEYS_ARE_DOWN(combo->state, key_count)) {
+            if (timer && timer_elapsed(timer) > time) {
+                // the combo's term has passed
+                combo->disabled = true;
+                return true;
+            }
+            combo_t *drop = NULL;
+            for (uint8_t i = combo_buffer_read; i != combo_buffer_write; INCREMENT_MOD(i)) {
+                if (combo_buffer[i] == (uint16_t)-1) {
+                    continue;
+                }
+                combo_t *buffered_combo = &key_combos[combo_buffer[i]];
+                if ((drop = overlaps(buffered_combo, combo))) {
+                    drop->disabled = true;
+                    if (drop == combo) {
+                        break;
+                    } else if (i == combo_buffer_read && drop == buffered_combo) {
+                        INCREMENT_MOD(combo_buffer_read);
+                    }
+                }
+            }
+            if (drop != combo) {
+                combo_buffer[combo_buffer_write] = combo_index;
+                INCREMENT_MOD(combo_buffer_write);
+                longest_term = wait_time(combo_index, combo);
+            }
+        }
+    } else {
+        if (!combo->active && ALL_COMBO_KEYS_ARE_DOWN(combo->state, key_count)) {
+            // first key quickly released
+            if (combo->disabled || must_hold(combo_index, combo)) {
+                drop_combo_from_buffer(combo_index);
+                key_is_part_of_combo = false;
+            } else if (must_tap(combo_index, combo)) {
+                apply_combo(combo_index, combo);
+                apply_combos();
+            }
+        } else if (combo->active && ONLY_ONE_KEY_IS_DOWN(combo->state) && KEY_NOT_YET_RELEASED(combo->state, key_index)) {
+            // last key released
+            release_combo(combo_index, combo);
+            key_is_part_of_combo = true;
+        } else if (combo->active && KEY_NOT_YET_RELEASED(combo->state, key_index)) {
+            // first or middle key released
+            key_is_part_of_combo = true;
+        } else {
+            // the released key was part of an incomplete combo
+            key_is_part_of_combo = false;
+        }
+        combo->state &= ~(1 << key_index);
+    }
+    return key_is_part_of_combo;
+}
+
+bool process_combo(uint16_t keycode, keyrecord_t *record) {
+    bool is_combo_key = false;
+
+#    ifdef COMBO_ONLY_FROM_LAYER
+    keycode = keymap_key_to_keycode(COMBO_ONLY_FROM_LAYER, record->event.key);
+#    endif
+
+    for (uint16_t index = 0; index < sim_combo_count(); index++) {
+        is_combo_key |= process_single_combo(&key_combos[index], keycode, record, index);
+    }
+
+    if (record->event.pressed && is_combo_key) {
+        timer = timer_read();
+        if (key_buffer_size < COMBO_KEY_BUFFER_LENGTH) {
+            key_buffer[key_buffer_size++] = (queued_record_t){.record = *record, .keycode = keycode, .combo_index = (uint16_t)-1};
+        }
+    } else {
+        if (combo_buffer_read != combo_buffer_write) {
+            apply_combos();
+        } else {
+            dump_key_buffer();
+            timer = 0;
+            clear_combos();
+        }
+    }
+    return !is_combo_key;
+}
+
+void combo_task(void) {
+    if (timer && timer_elapsed(timer) > longest_term) {
+        if (combo_buffer_read != combo_buffer_write) {
+            apply_combos();
+            longest_term = 0;
+            timer        = 0;
+        } else {
+            dump_key_buffer();
+            timer = 0;
+            clear_combos();
+        }
+    }
+}
+
+void combo_clear(void) {
+    timer = longest_term = 0;
+    key_buffer_size = key_buffer_next = 0;
+    combo_buffer_read = combo_buffer_write = 0;
+    for (uint16_t index = 0; index < sim_combo_count(); index++) {
+        key_combos[index].state    = 0;
+        key_combos[index].disabled = false;
+        key_combos[index].active   = false;
+    }
+}
+
+#endif
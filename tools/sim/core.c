@@ -0,0 +1,940 @@
+// Scan loop, action processing, layers and reports of the core model (QMK's keyboard.c, action.c,
+// action_layer.c, action_util.c and quantum.c).
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "internal.h"
+#include "ch.h"
+
+sim_settings_t  sim_settings;
+sim_callbacks_t sim_callbacks;
+keymap_config_t keymap_config;
+bool            debug_enable, debug_matrix, debug_keyboard, debug_mouse;
+layer_state_t   layer_state, default_layer_state;
+
+static uint64_t     now;      // µs
+static uint64_t     last_tick; // µs of the last tick event
+static matrix_row_t raw_matrix[MATRIX_ROWS], matrix[MATRIX_ROWS], previous_matrix[MATRIX_ROWS];
+static uint64_t     debounce_since; // µs of the last raw change, 0 if settled
+static uint8_t      source_layer[MATRIX_ROWS][MATRIX_COLS];
+static bool         press_pending[MATRIX_ROWS][MATRIX_COLS];   // pressed, not yet processed
+static bool         release_pending[MATRIX_ROWS][MATRIX_COLS]; // released, not yet processed
+static sim_quirks_t quirks;
+static uint32_t     press_count, press_of[MATRIX_ROWS][MATRIX_COLS];
+
+static uint8_t      real_mods, weak_mods, oneshot_mods;
+static uint8_t      keys[32];
+static uint16_t     consumer;
+static uint8_t      mouse_buttons;
+static sim_report_t host; // what the host saw last
+
+static int8_t oneshot_layer = -1; // layer of an OSL key, -1 if none
+static bool   oneshot_layer_held, oneshot_layer_used;
+
+#ifdef CAPS_WORD_ENABLE
+static bool     caps_word_active;
+static uint16_t caps_word_idle_timer;
+#endif
+
+/*
+ * Weak defaults of the hooks:
+ */
+
+#define WEAK __attribute__((weak))
+// clang-format off
+WEAK bool pre_process_record_kb(uint16_t keycode, keyrecord_t *record) { return pre_process_record_user(keycode, record); }
+WEAK bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) { return true; }
+WEAK bool process_record_kb(uint16_t keycode, keyrecord_t *record) { return process_record_user(keycode, record); }
+WEAK bool process_record_user(uint16_t keycode, keyrecord_t *record) { return true; }
+WEAK void post_process_record_kb(uint16_t keycode, keyrecord_t *record) { post_process_record_user(keycode, record); }
+WEAK void post_process_record_user(uint16_t keycode, keyrecord_t *record) {}
+WEAK void keyboard_pre_init_kb(void) { keyboard_pre_init_user(); }
+WEAK void keyboard_pre_init_user(void) {}
+WEAK void keyboard_post_init_kb(void) { keyboard_post_init_user(); }
+WEAK void keyboard_post_init_user(void) {}
+WEAK void matrix_init_kb(void) { matrix_init_user(); }
+WEAK void matrix_init_user(void) {}
+WEAK void matrix_scan_kb(void) { matrix_scan_user(); }
+WEAK void matrix_scan_user(void) {}
+WEAK void housekeeping_task_kb(void) { housekeeping_task_user(); }
+WEAK void housekeeping_task_user(void) {}
+WEAK layer_state_t layer_state_set_kb(layer_state_t state) { return layer_state_set_user(state); }
+WEAK layer_state_t layer_state_set_user(layer_state_t state) { return state; }
+WEAK layer_state_t default_layer_state_set_kb(layer_state_t state) { return default_layer_state_set_user(state); }
+WEAK layer_state_t default_layer_state_set_user(layer_state_t state) { return state; }
+// clang-format on
+
+/*
+ * Clock, matrix and console:
+ */
+
+uint16_t timer_read(void) {
+    return (uint16_t)(now / 1000);
+}
+
+uint32_t timer_read32(void) {
+    return (uint32_t)(now / 1000);
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return TIMER_DIFF_32(timer_read32(), last);
+}
+
+systime_t chVTGetSystemTimeX(void) {
+    return (systime_t)now;
+}
+
+// Blocking waits stall the keyboard: the clock advances, but nothing is scanned meanwhile.
+void wait_ms(uint32_t ms) {
+    now += (uint64_t)ms * 1000;
+}
+
+void wait_us(uint32_t us) {
+    now += us;
+}
+
+uint64_t sim_now(void) {
+    return now;
+}
+
+matrix_row_t matrix_get_row(uint8_t row) {
+    return matrix[row];
+}
+
+bool matrix_is_on(uint8_t row, uint8_t col) {
+    return matrix[row] & (1 << col);
+}
+
+void sim_print(const char *s) {
+    if (sim_callbacks.console) {
+        sim_callbacks.console(s, sim_callbacks.context);
+    }
+}
+
+void sim_printf(const char *fmt, ...) {
+    char    buffer[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    sim_print(buffer);
+}
+
+void reset_keyboard(void) {
+    sim_print("sim: reset_keyboard\n");
+}
+
+void soft_reset_keyboard(void) {
+    sim_print("sim: soft_reset_keyboard\n");
+}
+
+/*
+ * Reports:
+ */
+
+static void host_send(void) {
+    sim_report_t report = {.mods = real_mods | weak_mods | oneshot_mods, .consumer = consumer, .mouse = mouse_buttons};
+    memcpy(report.keys, keys, sizeof(keys));
+    report.time = host.time;
+    if (memcmp(&report, &host, sizeof(report)) == 0) {
+        return; // QMK only sends reports that differ from the previous one
+    }
+    report.time = now;
+    host        = report;
+    if (sim_callbacks.report) {
+        sim_callbacks.report(&host, sim_callbacks.context);
+    }
+}
+
+const sim_report_t *sim_report(void) {
+    return &host;
+}
+
+// clang-format off
+uint8_t get_mods(void) { return real_mods; }
+void add_mods(uint8_t mods) { real_mods |= mods; }
+void del_mods(uint8_t mods) { real_mods &= ~mods; }
+void set_mods(uint8_t mods) { real_mods = mods; }
+void clear_mods(void) { real_mods = 0; }
+uint8_t get_weak_mods(void) { return weak_mods; }
+void add_weak_mods(uint8_t mods) { weak_mods |= mods; }
+void del_weak_mods(uint8_t mods) { weak_mods &= ~mods; }
+void set_weak_mods(uint8_t mods) { weak_mods = mods; }
+void clear_weak_mods(void) { weak_mods = 0; }
+#ifndef NO_ACTION_ONESHOT
+uint8_t get_oneshot_mods(void) { return oneshot_mods; }
+void set_oneshot_mods(uint8_t mods) { oneshot_mods = mods; }
+void clear_oneshot_mods(void) { oneshot_mods = 0; }
+#endif
+void add_key(uint8_t key) { keys[key >> 3] |= 1 << (key & 7); }
+void del_key(uint8_t key) { keys[key >> 3] &= ~(1 << (key & 7)); }
+void clear_keys(void) { memset(keys, 0, sizeof(keys)); }
+void send_keyboard_report(void) { host_send(); }
+void register_mods(uint8_t mods) { if (mods) { add_mods(mods); send_keyboard_report(); } }
+void unregister_mods(uint8_t mods) { if (mods) { del_mods(mods); send_keyboard_report(); } }
+void register_weak_mods(uint8_t mods) { if (mods) { add_weak_mods(mods); send_keyboard_report(); } }
+void unregister_weak_mods(uint8_t mods) { if (mods) { del_weak_mods(mods); send_keyboard_report(); } }
+// clang-format on
+
+void clear_keyboard(void) {
+    clear_mods();
+    clear_weak_mods();
+    oneshot_mods = 0;
+    clear_keys();
+    consumer      = 0;
+    mouse_buttons = 0;
+    send_keyboard_report();
+}
+
+static uint16_t consumer_usage(uint8_t code) {
+    switch (code) {
+        case KC_AUDIO_MUTE:
+            return 0x00E2;
+        case KC_AUDIO_VOL_UP:
+            return 0x00E9;
+        case KC_AUDIO_VOL_DOWN:
+            return 0x00EA;
+        case KC_MEDIA_NEXT_TRACK:
+            return 0x00B5;
+        case KC_MEDIA_PREV_TRACK:
+            return 0x00B6;
+        case KC_MEDIA_STOP:
+            return 0x00B7;
+        case KC_MEDIA_PLAY_PAUSE:
+            return 0x00CD;
+        case KC_MEDIA_SELECT:
+            return 0x0183;
+        case KC_MEDIA_EJECT:
+            return 0x00B8;
+        case KC_BRIGHTNESS_UP:
+            return 0x006F;
+        case KC_BRIGHTNESS_DOWN:
+            return 0x0070;
+        default:
+            return 0;
+    }
+}
+
+void register_code(uint8_t code) {
+    if (code == KC_NO) {
+        return;
+    } else if (IS_BASIC_KEYCODE(code)) {
+        add_key(code);
+        send_keyboard_report();
+    } else if (IS_MODIFIER_KEYCODE(code)) {
+        add_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (IS_CONSUMER_KEYCODE(code)) {
+        consumer = consumer_usage(code);
+        host_send();
+    } else if (code >= KC_MS_BTN1 && code <= KC_MS_BTN5) {
+        mouse_buttons |= 1 << (code - KC_MS_BTN1);
+        host_send();
+    }
+}
+
+void unregister_code(uint8_t code) {
+    if (code == KC_NO) {
+        return;
+    } else if (IS_BASIC_KEYCODE(code)) {
+        del_key(code);
+        send_keyboard_report();
+    } else if (IS_MODIFIER_KEYCODE(code)) {
+        del_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (IS_CONSUMER_KEYCODE(code)) {
+        consumer = 0;
+        host_send();
+    } else if (code >= KC_MS_BTN1 && code <= KC_MS_BTN5) {
+        mouse_buttons &= ~(1 << (code - KC_MS_BTN1));
+        host_send();
+    }
+}
+
+// Converts the 5-bit modifier encoding of keycodes into an 8-bit modifier mask.
+static uint8_t mods_5bit_to_8bit(uint8_t mods) {
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+}
+
+void register_code16(uint16_t code) {
+    uint8_t mods = mods_5bit_to_8bit(QK_MODS_GET_MODS(code));
+    if (IS_MODIFIER_KEYCODE(code & 0xFF) || (code & 0xFF) == KC_NO) {
+        register_mods(mods);
+    } else {
+        register_weak_mods(mods);
+    }
+    register_code(code & 0xFF);
+}
+
+void unregister_code16(uint16_t code) {
+    uint8_t mods = mods_5bit_to_8bit(QK_MODS_GET_MODS(code));
+    unregister_code(code & 0xFF);
+    if (IS_MODIFIER_KEYCODE(code & 0xFF) || (code & 0xFF) == KC_NO) {
+        unregister_mods(mods);
+    } else {
+        unregister_weak_mods(mods);
+    }
+}
+
+void tap_code_delay(uint8_t code, uint16_t delay) {
+    register_code(code);
+    wait_ms(delay);
+    unregister_code(code);
+}
+
+void tap_code(uint8_t code) {
+    tap_code_delay(code, code == KC_CAPS_LOCK ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY);
+}
+
+void tap_code16_delay(uint16_t code, uint16_t delay) {
+    register_code16(code);
+    wait_ms(delay);
+    unregister_code16(code);
+}
+
+void tap_code16(uint16_t code) {
+    tap_code16_delay(code, code == KC_CAPS_LOCK ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY);
+}
+
+/*
+ * Strings (US ANSI host layout, like QMK's default `ascii_to_keycode_lut`):
+ */
+
+const uint8_t ascii_to_keycode_lut[128] PROGMEM = {
+    // NUL   SOH      STX      ETX      EOT      ENQ      ACK      BEL
+    XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,
+    // BS    TAB      LF       VT       FF       CR       SO       SI
+    KC_BSPC, KC_TAB,  KC_ENT,  XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,
+    // DLE   DC1      DC2      DC3      DC4      NAK      SYN      ETB
+    XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,
+    // CAN   EM       SUB      ESC      FS       GS       RS       US
+    XXXXXXX, XXXXXXX, XXXXXXX, KC_ESC,  XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,
+    //       !        "        #        $        %        &        '
+    KC_SPC,  KC_1,    KC_QUOT, KC_3,    KC_4,    KC_5,    KC_7,    KC_QUOT,
+    // (     )        *        +        ,        -        .        /
+    KC_9,    KC_0,    KC_8,    KC_EQL,  KC_COMM, KC_MINS, KC_DOT,  KC_SLSH,
+    // 0     1        2        3        4        5        6        7
+    KC_0,    KC_1,    KC_2,    KC_3,    KC_4,    KC_5,    KC_6,    KC_7,
+    // 8     9        :        ;        <        =        >        ?
+    KC_8,    KC_9,    KC_SCLN, KC_SCLN, KC_COMM, KC_EQL,  KC_DOT,  KC_SLSH,
+    // @     A        B        C        D        E        F        G
+    KC_2,    KC_A,    KC_B,    KC_C,    KC_D,    KC_E,    KC_F,    KC_G,
+    // H     I        J        K        L        M        N        O
+    KC_H,    KC_I,    KC_J,    KC_K,    KC_L,    KC_M,    KC_N,    KC_O,
+    // P     Q        R        S        T        U        V        W
+    KC_P,    KC_Q,    KC_R,    KC_S,    KC_T,    KC_U,    KC_V,    KC_W,
+    // X     Y        Z        [        \        ]        ^        _
+    KC_X,    KC_Y,    KC_Z,    KC_LBRC, KC_BSLS, KC_RBRC, KC_6,    KC_MINS,
+    // `     a        b        c        d        e        f        g
+    KC_GRV,  KC_A,    KC_B,    KC_C,    KC_D,    KC_E,    KC_F,    KC_G,
+    // h     i        j        k        l        m        n        o
+    KC_H,    KC_I,    KC_J,    KC_K,    KC_L,    KC_M,    KC_N,    KC_O,
+    // p     q        r        s        t        u        v        w
+    KC_P,    KC_Q,    KC_R,    KC_S,    KC_T,    KC_U,    KC_V,    KC_W,
+    // x     y        z        {        |        }        ~        DEL
+    KC_X,    KC_Y,    KC_Z,    KC_LBRC, KC_BSLS, KC_RBRC, KC_GRV,  KC_DEL,
+};
+
+const uint8_t ascii_to_shift_lut[16] PROGMEM = {
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 1, 1, 1, 1, 1, 1, 0),
+    KCLUT_ENTRY(1, 1, 1, 1, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 1, 0, 1, 0, 1, 1),
+    KCLUT_ENTRY(1, 1, 1, 1, 1, 1, 1, 1),
+    KCLUT_ENTRY(1, 1, 1, 1, 1, 1, 1, 1),
+    KCLUT_ENTRY(1, 1, 1, 1, 1, 1, 1, 1),
+    KCLUT_ENTRY(1, 1, 1, 0, 0, 0, 1, 1),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 1, 1, 1, 1, 0),
+};
+
+const uint8_t ascii_to_altgr_lut[16] PROGMEM = {
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+};
+
+const uint8_t ascii_to_dead_lut[16] PROGMEM = {
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+};
+
+void send_char(char ascii_code) {
+    if ((uint8_t)ascii_code >= 128) {
+        return;
+    }
+    uint8_t keycode    = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
+    bool    is_shifted = PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)ascii_code);
+    bool    is_altgr   = PGM_LOADBIT(ascii_to_altgr_lut, (uint8_t)ascii_code);
+    bool    is_dead    = PGM_LOADBIT(ascii_to_dead_lut, (uint8_t)ascii_code);
+    if (is_shifted) register_code(KC_LEFT_SHIFT);
+    if (is_altgr) register_code(KC_RIGHT_ALT);
+    tap_code(keycode);
+    if (is_altgr) unregister_code(KC_RIGHT_ALT);
+    if (is_shifted) unregister_code(KC_LEFT_SHIFT);
+    if (is_dead) tap_code(KC_SPACE);
+}
+
+void send_string(const char *string) {
+    for (; *string; string++) {
+        if (*string != SS_QMK_PREFIX) {
+            send_char(*string);
+            continue;
+        }
+        switch (*++string) {
+            case SS_TAP_CODE:
+                tap_code(*++string);
+                break;
+            case SS_DOWN_CODE:
+                register_code(*++string);
+                break;
+            case SS_UP_CODE:
+                unregister_code(*++string);
+                break;
+            case SS_DELAY_CODE: {
+                uint32_t ms = 0;
+                while (string[1] >= '0' && string[1] <= '9') {
+                    ms = ms * 10 + (*++string - '0');
+                }
+                if (string[1] == '|') string++;
+                wait_ms(ms);
+                break;
+            }
+        }
+    }
+}
+
+void send_string_P(const char *string) {
+    send_string(string);
+}
+
+/*
+ * Layers:
+ */
+
+void layer_state_set(layer_state_t state) {
+    layer_state = layer_state_set_kb(state);
+}
+
+bool layer_state_cmp(layer_state_t state, uint8_t layer) {
+    return state ? (state & ((layer_state_t)1 << layer)) : layer == 0;
+}
+
+bool layer_state_is(uint8_t layer) {
+    return layer_state_cmp(layer_state, layer);
+}
+
+// clang-format off
+void layer_on(uint8_t layer) { layer_state_set(layer_state | ((layer_state_t)1 << layer)); }
+void layer_off(uint8_t layer) { layer_state_set(layer_state & ~((layer_state_t)1 << layer)); }
+void layer_invert(uint8_t layer) { layer_state_set(layer_state ^ ((layer_state_t)1 << layer)); }
+void layer_move(uint8_t layer) { layer_state_set((layer_state_t)1 << layer); }
+void layer_clear(void) { layer_state_set(0); }
+void default_layer_set(layer_state_t state) { default_layer_state = default_layer_state_set_kb(state); }
+// clang-format on
+
+uint8_t get_highest_layer(layer_state_t state) {
+    uint8_t layer = 0;
+    while (state >>= 1) {
+        layer++;
+    }
+    return layer;
+}
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+    if (layer >= sim_layer_count() || key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return KC_NO;
+    }
+    return pgm_read_word(&keymaps[layer][key.row][key.col]);
+}
+
+static uint8_t layer_switch_get_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t i = 31; i >= 0; i--) {
+        if ((layers & ((layer_state_t)1 << i)) && keymap_key_to_keycode(i, key) != KC_TRANSPARENT) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+uint16_t get_record_keycode(keyrecord_t *record, bool update_layer_cache) {
+    if (record->keycode) {
+        return record->keycode;
+    }
+    keypos_t key = record->event.key;
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return KC_NO;
+    }
+    // Releases use the layer of the press, like QMK's source layers cache.
+    if (record->event.pressed && update_layer_cache) {
+        uint8_t layer = layer_switch_get_layer(key);
+        if (release_pending[key.row][key.col] && layer != source_layer[key.row][key.col]) {
+            quirks.source_layer_overwrites++; // the buffered release will be looked up on this layer
+        }
+        source_layer[key.row][key.col] = layer;
+    }
+    return keymap_key_to_keycode(source_layer[key.row][key.col], key);
+}
+
+/*
+ * Caps word (QMK's process_caps_word.c):
+ */
+
+#ifdef CAPS_WORD_ENABLE
+void caps_word_on(void) {
+    if (caps_word_active) return;
+    clear_mods();
+    oneshot_mods = 0;
+    clear_weak_mods();
+    caps_word_active     = true;
+    caps_word_idle_timer = timer_read() + CAPS_WORD_IDLE_TIMEOUT;
+}
+
+void caps_word_off(void) {
+    if (!caps_word_active) return;
+    unregister_weak_mods(MOD_MASK_SHIFT);
+    caps_word_active = false;
+}
+
+void caps_word_toggle(void) {
+    caps_word_active ? caps_word_off() : caps_word_on();
+}
+
+bool is_caps_word_on(void) {
+    return caps_word_active;
+}
+
+__attribute__((weak)) bool caps_word_press_user(uint16_t keycode) {
+    switch (keycode) {
+        case KC_A ... KC_Z:
+        case KC_MINS:
+            add_weak_mods(MOD_BIT(KC_LSFT));
+            return true;
+        case KC_1 ... KC_0:
+        case KC_BSPC:
+        case KC_DEL:
+        case KC_UNDS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool process_caps_word(uint16_t keycode, keyrecord_t *record) {
+    if (keycode == QK_CAPS_WORD_TOGGLE) {
+        if (record->event.pressed) caps_word_toggle();
+        return false;
+    }
+    if (!caps_word_active || !record->event.pressed) {
+        return true;
+    }
+    if (!((get_mods() | oneshot_mods) & ~(MOD_MASK_SHIFT | MOD_BIT(KC_RALT)))) {
+        switch (keycode) {
+            case KC_LEFT_CTRL ... KC_RIGHT_GUI:
+            case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX:
+            case QK_TO ... QK_TO_MAX:
+            case QK_MOMENTARY ... QK_MOMENTARY_MAX:
+            case QK_DEF_LAYER ... QK_DEF_LAYER_MAX:
+            case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:
+            case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:
+            case QK_LAYER_TAP_TOGGLE ... QK_LAYER_TAP_TOGGLE_MAX:
+                return true;
+            case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+                if (record->tap.count == 0) return true;
+                keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+                break;
+            case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+                if (record->tap.count == 0) return true;
+                keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+                break;
+            case QK_MODS ... QK_MODS_MAX:
+                if (QK_MODS_GET_MODS(keycode) & ~MOD_LSFT & ~MOD_RSFT & 0x0F) {
+                    break; // not a shifted keycode: deactivate below
+                }
+                keycode = (QK_MODS_GET_MODS(keycode) & MOD_LSFT) ? keycode : QK_MODS_GET_BASIC_KEYCODE(keycode);
+                break;
+        }
+        clear_weak_mods();
+        if (caps_word_press_user(keycode)) {
+            send_keyboard_report();
+            caps_word_idle_timer = timer_read() + CAPS_WORD_IDLE_TIMEOUT;
+            return true;
+        }
+    }
+    caps_word_off();
+    return true;
+}
+
+static void caps_word_task(void) {
+    if (caps_word_active && (int16_t)(timer_read() - caps_word_idle_timer) >= 0) {
+        caps_word_off();
+    }
+}
+#endif
+
+/*
+ * Actions (QMK's process_action(), looked up by keycode instead of action codes):
+ */
+
+static void process_action(keyrecord_t *record, uint16_t keycode) {
+    bool    pressed = record->event.pressed;
+    uint8_t tap     = record->tap.count;
+
+    switch (keycode) {
+        case QK_BASIC ... QK_BASIC_MAX:
+            pressed ? register_code(keycode) : unregister_code(keycode);
+            break;
+        case QK_MODS ... QK_MODS_MAX: {
+            uint8_t mods = mods_5bit_to_8bit(QK_MODS_GET_MODS(keycode));
+            uint8_t code = QK_MODS_GET_BASIC_KEYCODE(keycode);
+            bool    real = IS_MODIFIER_KEYCODE(code) || code == KC_NO;
+            if (pressed) {
+                real ? add_mods(mods) : add_weak_mods(mods);
+                send_keyboard_report();
+                register_code(code);
+            } else {
+                unregister_code(code);
+                real ? del_mods(mods) : del_weak_mods(mods);
+                send_keyboard_report();
+            }
+            break;
+        }
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX: {
+            uint8_t mods = mods_5bit_to_8bit(QK_MOD_TAP_GET_MODS(keycode));
+            uint8_t code = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+            if (tap > 0) {
+                pressed ? register_code(code) : unregister_code(code);
+            } else {
+                pressed ? register_mods(mods) : unregister_mods(mods);
+            }
+            break;
+        }
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX: {
+            uint8_t code = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+            if (tap > 0) {
+                pressed ? register_code(code) : unregister_code(code);
+            } else {
+                pressed ? layer_on(QK_LAYER_TAP_GET_LAYER(keycode)) : layer_off(QK_LAYER_TAP_GET_LAYER(keycode));
+            }
+            break;
+        }
+        case QK_MOMENTARY ... QK_MOMENTARY_MAX:
+            pressed ? layer_on(QK_MOMENTARY_GET_LAYER(keycode)) : layer_off(QK_MOMENTARY_GET_LAYER(keycode));
+            break;
+        case QK_DEF_LAYER ... QK_DEF_LAYER_MAX:
+            if (pressed) default_layer_set((layer_state_t)1 << QK_DEF_LAYER_GET_LAYER(keycode));
+            break;
+        case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:
+            if (!pressed) layer_invert(QK_TOGGLE_LAYER_GET_LAYER(keycode));
+            break;
+        case QK_TO ... QK_TO_MAX:
+            if (pressed) layer_move(QK_TO_GET_LAYER(keycode));
+            break;
+        case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:
+            if (pressed) {
+                oneshot_layer      = QK_ONE_SHOT_LAYER_GET_LAYER(keycode);
+                oneshot_layer_held = true;
+                oneshot_layer_used = false;
+                layer_on(oneshot_layer);
+            } else {
+                oneshot_layer_held = false;
+                if (oneshot_layer_used && oneshot_layer >= 0) {
+                    layer_off(oneshot_layer);
+                    oneshot_layer = -1;
+                }
+            }
+            break;
+        case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX: {
+            // Simplified: behaves like the modifier while held.
+            uint8_t mods = mods_5bit_to_8bit(QK_ONE_SHOT_MOD_GET_MODS(keycode));
+            pressed ? register_mods(mods) : unregister_mods(mods);
+            break;
+        }
+        case QK_BOOT:
+            if (pressed) reset_keyboard();
+            break;
+        case QK_REBOOT:
+            if (pressed) soft_reset_keyboard();
+            break;
+    }
+}
+
+// A press of any other key ends a pending one-shot layer after that key was processed.
+static void oneshot_layer_after_press(uint16_t keycode) {
+    if (oneshot_layer < 0 || IS_QK_ONE_SHOT_LAYER(keycode)) {
+        return;
+    }
+    if (oneshot_layer_held) {
+        oneshot_layer_used = true;
+    } else {
+        layer_off(oneshot_layer);
+        oneshot_layer = -1;
+    }
+}
+
+static bool process_record_quantum(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, true);
+#ifdef TAP_DANCE_ENABLE
+    if (preprocess_tap_dance(keycode, record)) {
+        // The tap dance might have changed the layer state, so the keycode has to be looked up again.
+        keycode = get_record_keycode(record, true);
+    }
+#endif
+    if (record->event.pressed && IS_KEYEVENT(record->event)) {
+        if (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) {
+            sim_decide(record->tap.count ? SIM_TAP : SIM_HOLD, record->event.key, keycode, 0);
+        }
+    }
+    return
+#ifdef REPEAT_KEY_ENABLE
+        process_last_key(keycode, record) && process_repeat_key(keycode, record) &&
+#endif
+#ifdef CAPS_WORD_ENABLE
+        process_caps_word(keycode, record) &&
+#endif
+        process_record_kb(keycode, record) &&
+#ifdef KEY_OVERRIDE_ENABLE
+        process_key_override(keycode, record) &&
+#endif
+#ifdef TAP_DANCE_ENABLE
+        process_tap_dance(keycode, record) &&
+#endif
+        true;
+}
+
+void process_record(keyrecord_t *record) {
+    process_record_with_mods(record, 0);
+}
+
+// With `weak_mods` in place of those of the previous key, e.g. for the Repeat Key.
+void process_record_with_mods(keyrecord_t *record, uint8_t weak_mods) {
+    if (IS_NOEVENT(record->event)) {
+        return;
+    }
+    if (record->event.pressed) {
+        // Weak mods of the previous key must not leak into this one.
+        clear_weak_mods();
+        add_weak_mods(weak_mods);
+    }
+    if (IS_KEYEVENT(record->event)) {
+        keypos_t key = record->event.key;
+        if (record->event.pressed) {
+            press_pending[key.row][key.col] = false;
+        } else {
+            if (press_pending[key.row][key.col]) {
+                quirks.early_releases++;
+                press_pending[key.row][key.col] = false;
+            }
+            release_pending[key.row][key.col] = false;
+        }
+    }
+    uint16_t keycode = get_record_keycode(record, false);
+    if (process_record_quantum(record)) {
+        keycode = get_record_keycode(record, false);
+        process_action(record, keycode);
+        post_process_record_kb(keycode, record);
+    }
+    if (record->event.pressed) {
+        oneshot_layer_after_press(keycode);
+    }
+}
+
+/*
+ * Scan loop (QMK's keyboard_task()):
+ */
+
+static void action_exec(keyevent_t event) {
+    keyrecord_t record = {.event = event};
+    if (IS_KEYEVENT(event)) {
+        (event.pressed ? press_pending : release_pending)[event.key.row][event.key.col] = true;
+    }
+    if (IS_EVENT(event)) {
+        uint16_t keycode = get_record_keycode(&record, true);
+        if (!pre_process_record_kb(keycode, &record)) {
+            return;
+        }
+#ifdef COMBO_ENABLE
+        if (!process_combo(keycode, &record)) {
+            return;
+        }
+#endif
+    }
+    action_tapping_process(record);
+}
+
+const sim_quirks_t *sim_quirks(void) {
+    return &quirks;
+}
+
+uint32_t sim_press_of(keypos_t key) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return 0;
+    }
+    return press_of[key.row][key.col];
+}
+
+void sim_decide(sim_decision_kind_t kind, keypos_t key, uint16_t keycode, uint8_t data) {
+    sim_decision_t decision = {.time = now, .kind = kind, .key = key, .keycode = keycode, .data = data, .press = sim_press_of(key)};
+    if (sim_callbacks.decision) {
+        sim_callbacks.decision(&decision, sim_callbacks.context);
+    }
+}
+
+static void scan(void) {
+    // sym_defer_g: the matrix is taken over once the raw state has been stable for DEBOUNCE ms.
+    if (debounce_since && now - debounce_since >= (uint64_t)DEBOUNCE * 1000) {
+        memcpy(matrix, raw_matrix, sizeof(matrix));
+        debounce_since = 0;
+    }
+    matrix_scan_kb();
+
+    bool changed = false;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix_row_t diff = matrix[row] ^ previous_matrix[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (!(diff & (1 << col))) continue;
+            bool pressed = matrix[row] & (1 << col);
+            if (pressed) {
+                press_of[row][col] = ++press_count;
+            }
+            action_exec((keyevent_t){.key = MAKE_KEYPOS(row, col), .pressed = pressed, .time = timer_read() | 1, .type = KEY_EVENT});
+            previous_matrix[row] ^= 1 << col;
+            changed = true;
+        }
+    }
+    if (!changed && now - last_tick >= 1000) {
+        last_tick = now;
+        action_exec((keyevent_t){.time = timer_read() | 1, .type = TICK_EVENT});
+    }
+
+#ifdef COMBO_ENABLE
+    combo_task();
+#endif
+#ifdef TAP_DANCE_ENABLE
+    tap_dance_task();
+#endif
+#ifdef CAPS_WORD_ENABLE
+    caps_word_task();
+#endif
+    housekeeping_task_kb();
+}
+
+void sim_key(uint8_t row, uint8_t col, bool pressed) {
+    if (row >= MATRIX_ROWS || col >= MATRIX_COLS || ((raw_matrix[row] >> col) & 1) == pressed) {
+        return;
+    }
+    raw_matrix[row] ^= 1 << col;
+    debounce_since = now ? now : 1;
+}
+
+void sim_run_until(uint64_t time) {
+    // The clock moves on by whole scan intervals; a stall inside a scan (wait_ms) delays the next.
+    uint64_t next = now - now % sim_settings.scan_interval + sim_settings.scan_interval;
+    while (next <= time) {
+        if (now < next) now = next;
+        scan();
+        next = now - now % sim_settings.scan_interval + sim_settings.scan_interval;
+    }
+    if (now < time) now = time;
+}
+
+void sim_default_settings(void) {
+    sim_settings = (sim_settings_t){
+        .tapping_term            = SIM_KEYMAP_TAPPING_TERM,
+        .quick_tap_term          = SIM_KEYMAP_QUICK_TAP_TERM,
+        .combo_term              = SIM_KEYMAP_COMBO_TERM,
+        .combo_hold_term         = SIM_KEYMAP_COMBO_HOLD_TERM,
+        .debounce                = SIM_KEYMAP_DEBOUNCE,
+        .scan_interval           = 500,
+        .permissive_hold         = SIM_KEYMAP,
+        .hold_on_other_key_press = SIM_KEYMAP,
+    };
+}
+
+void sim_reset(void) {
+    if (!sim_settings.scan_interval) {
+        sim_default_settings();
+    }
+    now = last_tick = debounce_since = 0;
+    memset(raw_matrix, 0, sizeof(raw_matrix));
+    memset(matrix, 0, sizeof(matrix));
+    memset(previous_matrix, 0, sizeof(previous_matrix));
+    memset(source_layer, 0, sizeof(source_layer));
+    memset(press_pending, 0, sizeof(press_pending));
+    memset(release_pending, 0, sizeof(release_pending));
+    quirks = (sim_quirks_t){0};
+    memset(press_of, 0, sizeof(press_of));
+    press_count = 0;
+    real_mods = weak_mods = oneshot_mods = 0;
+    clear_keys();
+    consumer = mouse_buttons = 0;
+    memset(&host, 0, sizeof(host));
+    oneshot_layer = -1;
+    layer_state = default_layer_state = 0;
+#ifdef CAPS_WORD_ENABLE
+    caps_word_active = false;
+#endif
+    // As after a fresh EEPROM: NKRO is off unless the keymap forces it (or it is toggled on).
+#if defined(NKRO_ENABLE) && defined(FORCE_NKRO)
+    keymap_config.nkro = true;
+#else
+    keymap_config.nkro = false;
+#endif
+    keymap_config.oneshot_enable = true;
+    action_tapping_clear();
+#ifdef COMBO_ENABLE
+    combo_clear();
+#endif
+#ifdef TAP_DANCE_ENABLE
+    tap_dance_clear();
+#endif
+#ifdef KEY_OVERRIDE_ENABLE
+    key_override_clear();
+#endif
+#ifdef REPEAT_KEY_ENABLE
+    repeat_key_clear();
+#endif
+
+    keyboard_pre_init_kb();
+    matrix_init_kb();
+    keyboard_post_init_kb();
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host-side stand-in for the ChibiOS system timer, which ticks at 1 MHz on the RP2040.
+
+#include <stdint.h>
+
+typedef uint32_t systime_t;
+
+systime_t chVTGetSystemTimeX(void);
+
+#define TIME_I2US(interval) ((uint32_t)(interval))
@@ -0,0 +1,26 @@
+#pragma once
+
+// Host-side stand-in for QMK's `print.h`: console output goes to the console callback (see sim.h).
+
+#include <stdbool.h>
+
+extern bool debug_enable;
+extern bool debug_matrix;
+extern bool debug_keyboard;
+extern bool debug_mouse;
+
+void sim_print(const char *s);
+void sim_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#define print(s) sim_print(s)
+#define uprint(s) sim_print(s)
+#define uprintf(...) sim_printf(__VA_ARGS__)
+#define xprintf(...) sim_printf(__VA_ARGS__)
+#define dprint(s)                       \
+    do {                                \
+        if (debug_enable) sim_print(s); \
+    } while (0)
+#define dprintf(...)                                \
+    do {                                            \
+        if (debug_enable) sim_printf(__VA_ARGS__); \
+    } while (0)
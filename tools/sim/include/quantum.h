@@ -0,0 +1,325 @@
+#pragma once
+
+// Host-side stand-in for QMK's `quantum.h`. It declares the subset of the QMK API that the
+// keymaps and features/ of this keyboard use; tools/sim/*.c implement it. The behaviour follows
+// QMK 0.22 closely enough for replaying typing, see tools/readme.md for the known differences.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "keycodes.h"
+#include "print.h"
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define memcpy_P(dest, src, n) memcpy(dest, src, n)
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Timer:
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+#define TIMER_DIFF_32(a, b) ((uint32_t)((a) - (b)))
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+void     wait_ms(uint32_t ms);
+void     wait_us(uint32_t us);
+
+// Matrix and key events:
+typedef uint8_t matrix_row_t;
+matrix_row_t matrix_get_row(uint8_t row);
+bool         matrix_is_on(uint8_t row, uint8_t col);
+
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+typedef enum {
+    TICK_EVENT  = 0,
+    KEY_EVENT   = 1,
+    COMBO_EVENT = 4,
+} keyevent_type_t;
+
+typedef struct {
+    keypos_t        key;
+    uint16_t        time;
+    keyevent_type_t type;
+    bool            pressed;
+} keyevent_t;
+
+typedef struct {
+    bool    interrupted : 1;
+    bool    reserved2 : 1;
+    bool    reserved1 : 1;
+    bool    reserved0 : 1;
+    uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+    keyevent_t event;
+    tap_t      tap;
+    uint16_t   keycode;
+} keyrecord_t;
+
+#define KEYLOC_COMBO 254
+#define MAKE_KEYPOS(row_num, col_num) ((keypos_t){.row = (row_num), .col = (col_num)})
+#define KEYEQ(keya, keyb) ((keya).row == (keyb).row && (keya).col == (keyb).col)
+#define IS_NOEVENT(event) ((event).type == TICK_EVENT)
+#define IS_EVENT(event) ((event).type != TICK_EVENT)
+#define IS_KEYEVENT(event) ((event).type == KEY_EVENT)
+#define IS_COMBOEVENT(event) ((event).type == COMBO_EVENT)
+
+// Layers:
+typedef uint32_t layer_state_t;
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+void                 layer_state_set(layer_state_t state);
+bool                 layer_state_is(uint8_t layer);
+bool                 layer_state_cmp(layer_state_t state, uint8_t layer);
+void                 layer_on(uint8_t layer);
+void                 layer_off(uint8_t layer);
+void                 layer_invert(uint8_t layer);
+void                 layer_move(uint8_t layer);
+void                 layer_clear(void);
+uint8_t              get_highest_layer(layer_state_t state);
+void                 default_layer_set(layer_state_t state);
+#define IS_LAYER_ON(layer) layer_state_is(layer)
+#define IS_LAYER_OFF(layer) (!layer_state_is(layer))
+layer_state_t layer_state_set_kb(layer_state_t state);
+layer_state_t layer_state_set_user(layer_state_t state);
+layer_state_t default_layer_state_set_kb(layer_state_t state);
+layer_state_t default_layer_state_set_user(layer_state_t state);
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+uint16_t              keymap_key_to_keycode(uint8_t layer, keypos_t key);
+uint16_t              get_record_keycode(keyrecord_t *record, bool update_layer_cache);
+
+// Modifiers and the keyboard report:
+uint8_t get_mods(void);
+void    add_mods(uint8_t mods);
+void    del_mods(uint8_t mods);
+void    set_mods(uint8_t mods);
+void    clear_mods(void);
+uint8_t get_weak_mods(void);
+void    add_weak_mods(uint8_t mods);
+void    del_weak_mods(uint8_t mods);
+void    set_weak_mods(uint8_t mods);
+void    clear_weak_mods(void);
+#ifndef NO_ACTION_ONESHOT // not defined then, as in QMK, so that a build that uses them fails
+uint8_t get_oneshot_mods(void);
+void    set_oneshot_mods(uint8_t mods);
+void    clear_oneshot_mods(void);
+#endif
+void    register_mods(uint8_t mods);
+void    unregister_mods(uint8_t mods);
+void    register_weak_mods(uint8_t mods);
+void    unregister_weak_mods(uint8_t mods);
+void    add_key(uint8_t key);
+void    del_key(uint8_t key);
+void    clear_keys(void);
+void    clear_keyboard(void);
+void    send_keyboard_report(void);
+void    register_code(uint8_t code);
+void    unregister_code(uint8_t code);
+void    register_code16(uint16_t code);
+void    unregister_code16(uint16_t code);
+#ifndef TAP_CODE_DELAY
+#    define TAP_CODE_DELAY 0
+#endif
+#ifndef TAP_HOLD_CAPS_DELAY
+#    define TAP_HOLD_CAPS_DELAY 80
+#endif
+void    tap_code(uint8_t code);
+void    tap_code16(uint16_t code);
+void    tap_code_delay(uint8_t code, uint16_t delay);
+void    tap_code16_delay(uint16_t code, uint16_t delay);
+
+typedef union {
+    uint16_t raw;
+    struct {
+        bool nkro : 1;
+        bool oneshot_enable : 1;
+    };
+} keymap_config_t;
+extern keymap_config_t keymap_config;
+
+// Strings:
+void send_string(const char *string);
+void send_string_P(const char *string);
+void send_char(char ascii_code);
+#define KCLUT_ENTRY(a, b, c, d, e, f, g, h) ((a) << 0 | (b) << 1 | (c) << 2 | (d) << 3 | (e) << 4 | (f) << 5 | (g) << 6 | (h) << 7)
+#define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
+extern const uint8_t ascii_to_keycode_lut[128];
+extern const uint8_t ascii_to_shift_lut[16];
+extern const uint8_t ascii_to_altgr_lut[16];
+extern const uint8_t ascii_to_dead_lut[16];
+#define SEND_STRING(string) send_string_P(PSTR(string))
+#define SS_QMK_PREFIX 1
+#define SS_TAP_CODE 1
+#define SS_DOWN_CODE 2
+#define SS_UP_CODE 3
+#define SS_DELAY_CODE 4
+
+// Quantum:
+void reset_keyboard(void);
+void soft_reset_keyboard(void);
+bool pre_process_record_kb(uint16_t keycode, keyrecord_t *record);
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record);
+bool process_record_kb(uint16_t keycode, keyrecord_t *record);
+bool process_record_user(uint16_t keycode, keyrecord_t *record);
+void post_process_record_kb(uint16_t keycode, keyrecord_t *record);
+void post_process_record_user(uint16_t keycode, keyrecord_t *record);
+void keyboard_pre_init_kb(void);
+void keyboard_pre_init_user(void);
+void keyboard_post_init_kb(void);
+void keyboard_post_init_user(void);
+void matrix_init_kb(void);
+void matrix_init_user(void);
+void matrix_scan_kb(void);
+void matrix_scan_user(void);
+void housekeeping_task_kb(void);
+void housekeeping_task_user(void);
+
+// Tap-hold:
+#ifndef TAPPING_TERM
+#    define TAPPING_TERM 200
+#endif
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record);
+uint16_t get_quick_tap_term(uint16_t keycode, keyrecord_t *record);
+bool     get_permissive_hold(uint16_t keycode, keyrecord_t *record);
+bool     get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record);
+
+// Combos:
+#ifdef COMBO_ENABLE
+#    define COMBO_END 0
+typedef struct {
+    const uint16_t *keys;
+    uint16_t        keycode;
+    uint8_t         state;
+    bool            disabled;
+    bool            active;
+} combo_t;
+#    define COMBO(ck, ca) \
+        { .keys = &(ck)[0], .keycode = (ca) }
+#    define COMBO_ACTION(ck) \
+        { .keys = &(ck)[0] }
+extern combo_t key_combos[];
+uint16_t       get_combo_term(uint16_t index, combo_t *combo);
+bool           get_combo_must_hold(uint16_t index, combo_t *combo);
+bool           get_combo_must_tap(uint16_t index, combo_t *combo);
+void           process_combo_event(uint16_t combo_index, bool pressed);
+#endif
+
+// Tap dance:
+#ifdef TAP_DANCE_ENABLE
+typedef struct {
+    uint16_t interrupting_keycode;
+    uint8_t  count;
+    uint8_t  weak_mods;
+    bool     pressed : 1;
+    bool     finished : 1;
+    bool     interrupted : 1;
+} tap_dance_state_t;
+
+typedef void (*tap_dance_user_fn_t)(tap_dance_state_t *state, void *user_data);
+
+typedef struct {
+    tap_dance_state_t state;
+    struct {
+        tap_dance_user_fn_t on_each_tap;
+        tap_dance_user_fn_t on_dance_finished;
+        tap_dance_user_fn_t on_reset;
+        tap_dance_user_fn_t on_each_release;
+    } fn;
+    void *user_data;
+} tap_dance_action_t;
+
+typedef struct {
+    uint16_t kc1;
+    uint16_t kc2;
+} tap_dance_pair_t;
+
+#    define ACTION_TAP_DANCE_DOUBLE(kc1, kc2) \
+        { .fn = {tap_dance_pair_on_each_tap, tap_dance_pair_finished, tap_dance_pair_reset, NULL}, .user_data = (void *)&((tap_dance_pair_t){kc1, kc2}), }
+#    define ACTION_TAP_DANCE_FN(user_fn) \
+        { .fn = {NULL, user_fn, NULL, NULL}, .user_data = NULL, }
+#    define ACTION_TAP_DANCE_FN_ADVANCED(user_fn_on_each_tap, user_fn_on_dance_finished, user_fn_on_dance_reset) \
+        { .fn = {user_fn_on_each_tap, user_fn_on_dance_finished, user_fn_on_dance_reset, NULL}, .user_data = NULL, }
+#    define ACTION_TAP_DANCE_FN_ADVANCED_WITH_RELEASE(user_fn_on_each_tap, user_fn_on_each_release, user_fn_on_dance_finished, user_fn_on_dance_reset) \
+        { .fn = {user_fn_on_each_tap, user_fn_on_dance_finished, user_fn_on_dance_reset, user_fn_on_each_release}, .user_data = NULL, }
+
+extern tap_dance_action_t tap_dance_actions[];
+void                      tap_dance_pair_on_each_tap(tap_dance_state_t *state, void *user_data);
+void                      tap_dance_pair_finished(tap_dance_state_t *state, void *user_data);
+void                      tap_dance_pair_reset(tap_dance_state_t *state, void *user_data);
+#endif
+
+// Key overrides:
+#ifdef KEY_OVERRIDE_ENABLE
+typedef enum {
+    ko_option_activation_trigger_down      = (1 << 0),
+    ko_option_activation_required_mod_down = (1 << 1),
+    ko_option_activation_negative_mod_up   = (1 << 2),
+    ko_option_one_mod                      = (1 << 3),
+    ko_option_no_reregister_trigger        = (1 << 4),
+    ko_option_no_unregister_on_other_key_down = (1 << 5),
+    ko_options_all_activations = ko_option_activation_negative_mod_up | ko_option_activation_required_mod_down | ko_option_activation_trigger_down,
+    ko_options_default = ko_options_all_activations,
+} ko_option_t;
+
+typedef struct {
+    uint16_t      trigger;
+    uint8_t       trigger_mods;
+    layer_state_t layers;
+    uint8_t       negative_mod_mask;
+    uint8_t       suppressed_mods;
+    uint16_t      replacement;
+    ko_option_t   options;
+    bool (*custom_action)(bool activated, void *context);
+    void *context;
+    bool *enabled;
+} key_override_t;
+
+#    define ko_make_with_layers_negmods_and_options(trigger_mods_, trigger_key, replacement_key, layer_mask, negative_mask, options_) \
+        ((const key_override_t){.trigger_mods = (trigger_mods_), .layers = (layer_mask), .suppressed_mods = (trigger_mods_), .options = (options_), .negative_mod_mask = (negative_mask), .custom_action = NULL, .context = NULL, .trigger = (trigger_key), .replacement = (replacement_key), .enabled = NULL})
+#    define ko_make_with_layers_and_negmods(trigger_mods, trigger_key, replacement_key, layer_mask, negative_mask) \
+        ko_make_with_layers_negmods_and_options(trigger_mods, trigger_key, replacement_key, layer_mask, negative_mask, ko_options_default)
+#    define ko_make_with_layers(trigger_mods, trigger_key, replacement_key, layer_mask) \
+        ko_make_with_layers_and_negmods(trigger_mods, trigger_key, replacement_key, layer_mask, 0)
+#    define ko_make_basic(trigger_mods, trigger_key, replacement_key) \
+        ko_make_with_layers(trigger_mods, trigger_key, replacement_key, ~((layer_state_t)0))
+
+extern const key_override_t **key_overrides;
+#endif
+
+// Repeat key:
+#ifdef REPEAT_KEY_ENABLE
+uint16_t get_last_keycode(void);
+uint8_t  get_last_mods(void);
+void     set_last_keycode(uint16_t keycode);
+void     set_last_mods(uint8_t mods);
+uint16_t get_alt_repeat_key_keycode(void);
+int8_t   get_repeat_key_count(void);
+void     repeat_key_invoke(const keyevent_t *event);
+void     alt_repeat_key_invoke(const keyevent_t *event);
+bool     remember_last_key_user(uint16_t keycode, keyrecord_t *record, uint8_t *remembered_mods);
+uint16_t get_alt_repeat_key_keycode_user(uint16_t keycode, uint8_t mods);
+#endif
+
+// Caps word:
+#ifdef CAPS_WORD_ENABLE
+#    ifndef CAPS_WORD_IDLE_TIMEOUT
+#        define CAPS_WORD_IDLE_TIMEOUT 5000
+#    endif
+void caps_word_on(void);
+void caps_word_off(void);
+void caps_word_toggle(void);
+bool is_caps_word_on(void);
+bool caps_word_press_user(uint16_t keycode);
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+// Force-included after the keyboard's and the keymap's config.h (see sim.mk). The keymap's
+// timing settings are captured here and then replaced by fields of `sim_settings`, so that the
+// tools can run the same keymap code with other values.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef TAPPING_TERM
+#    define TAPPING_TERM 200
+#endif
+#ifndef QUICK_TAP_TERM
+#    ifdef TAPPING_FORCE_HOLD
+#        define QUICK_TAP_TERM 0
+#    else
+#        define QUICK_TAP_TERM TAPPING_TERM
+#    endif
+#endif
+#ifndef COMBO_TERM
+#    define COMBO_TERM 50
+#endif
+#ifndef COMBO_HOLD_TERM
+#    define COMBO_HOLD_TERM TAPPING_TERM
+#endif
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+enum sim_keymap_settings {
+    SIM_KEYMAP_TAPPING_TERM    = TAPPING_TERM,
+    SIM_KEYMAP_QUICK_TAP_TERM  = QUICK_TAP_TERM,
+    SIM_KEYMAP_COMBO_TERM      = COMBO_TERM,
+    SIM_KEYMAP_COMBO_HOLD_TERM = COMBO_HOLD_TERM,
+    SIM_KEYMAP_DEBOUNCE        = DEBOUNCE,
+};
+
+// Value of the boolean settings that keeps what the keymap's config.h says:
+#define SIM_KEYMAP (-1)
+
+typedef struct {
+    uint16_t tapping_term;
+    uint16_t quick_tap_term;
+    uint16_t combo_term;
+    uint16_t combo_hold_term;
+    uint16_t per_combo_term;          // ms for the combos with a term of their own, 0: the keymap's
+    uint16_t debounce;                // ms, sym_defer_g
+    uint16_t scan_interval;           // µs between two matrix scans
+    int8_t   permissive_hold;         // SIM_KEYMAP, false or true (the latter ignore *_PER_KEY)
+    int8_t   hold_on_other_key_press; // SIM_KEYMAP, false or true (the latter ignore *_PER_KEY)
+} sim_settings_t;
+
+extern sim_settings_t sim_settings;
+
+#undef TAPPING_TERM
+#define TAPPING_TERM (sim_settings.tapping_term)
+#undef QUICK_TAP_TERM
+#define QUICK_TAP_TERM (sim_settings.quick_tap_term)
+#undef COMBO_TERM
+#define COMBO_TERM (sim_settings.combo_term)
+#undef COMBO_HOLD_TERM
+#define COMBO_HOLD_TERM (sim_settings.combo_hold_term)
+#undef DEBOUNCE
+#define DEBOUNCE (sim_settings.debounce)
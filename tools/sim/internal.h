@@ -0,0 +1,37 @@
+#pragma once
+
+// Interfaces between the parts of the core model (not for the tools).
+
+#include "sim.h"
+
+void     process_record(keyrecord_t *record);
+void     process_record_with_mods(keyrecord_t *record, uint8_t weak_mods);
+void     action_tapping_process(keyrecord_t record);
+void     action_tapping_clear(void);
+void     sim_decide(sim_decision_kind_t kind, keypos_t key, uint16_t keycode, uint8_t data);
+uint32_t sim_press_of(keypos_t key);
+
+#ifdef COMBO_ENABLE
+bool process_combo(uint16_t keycode, keyrecord_t *record);
+void combo_task(void);
+void combo_clear(void);
+#endif
+
+#ifdef TAP_DANCE_ENABLE
+bool     preprocess_tap_dance(uint16_t keycode, keyrecord_t *record);
+bool     process_tap_dance(uint16_t keycode, keyrecord_t *record);
+void     tap_dance_task(void);
+void     tap_dance_clear(void);
+uint16_t sim_tap_dance_count(void);
+#endif
+
+#ifdef KEY_OVERRIDE_ENABLE
+bool process_key_override(uint16_t keycode, keyrecord_t *record);
+void key_override_clear(void);
+#endif
+
+#ifdef REPEAT_KEY_ENABLE
+bool process_last_key(uint16_t keycode, keyrecord_t *record);
+bool process_repeat_key(uint16_t keycode, keyrecord_t *record);
+void repeat_key_clear(void);
+#endif
@@ -0,0 +1,89 @@
+// Key overrides, a simplified model of QMK's process_key_override.c (0.22): an override activates
+// on the press of its trigger and deactivates on the trigger's release or any other press. Custom
+// actions, `enabled` flags and the reregistering of the trigger are not modelled.
+
+#include "internal.h"
+
+#ifdef KEY_OVERRIDE_ENABLE
+
+static const key_override_t *active_override;
+static keypos_t              active_key;
+static uint8_t               suppressed; // trigger mods taken off while the override is active
+
+// All required modifiers must be down, ignoring left/right (unless ko_option_one_mod).
+static bool check_mods(uint8_t mods, uint8_t required, bool one_mod) {
+    uint8_t mods_lr     = (mods | mods >> 4) & 0x0F;
+    uint8_t required_lr = (required | required >> 4) & 0x0F;
+    return one_mod ? (mods_lr & required_lr) != 0 : (mods_lr & required_lr) == required_lr;
+}
+
+static void deactivate(void) {
+    if (!active_override) {
+        return;
+    }
+    unregister_code16(active_override->replacement);
+    add_mods(suppressed);
+    send_keyboard_report();
+    active_override = NULL;
+    suppressed      = 0;
+}
+
+static uint8_t modifiers_of(uint16_t keycode, keyrecord_t *record) {
+    if (IS_MODIFIER_KEYCODE(keycode)) {
+        return MOD_BIT(keycode);
+    }
+    if (IS_QK_MOD_TAP(keycode) && record->tap.count == 0) {
+        uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+        return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+    }
+    return 0;
+}
+
+bool process_key_override(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        // a released modifier must not come back when the override ends
+        suppressed &= ~modifiers_of(keycode, record);
+        if (active_override && KEYEQ(record->event.key, active_key)) {
+            deactivate();
+            return false;
+        }
+        return true;
+    }
+
+    deactivate();
+    if ((IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && record->tap.count == 0) {
+        return true; // holds never trigger an override
+    }
+    uint8_t       mods  = get_mods() | get_weak_mods();
+#ifndef NO_ACTION_ONESHOT
+    mods |= get_oneshot_mods();
+#endif
+    layer_state_t layer = (layer_state_t)1 << get_highest_layer(layer_state | default_layer_state);
+    for (const key_override_t **override = key_overrides; *override; override++) {
+        const key_override_t *candidate = *override;
+        if (candidate->trigger != keycode || !(candidate->layers & layer)) {
+            continue;
+        }
+        if (!check_mods(mods, candidate->trigger_mods, candidate->options & ko_option_one_mod) || (mods & candidate->negative_mod_mask)) {
+            continue;
+        }
+        active_override = candidate;
+        active_key      = record->event.key;
+        suppressed      = get_mods() & candidate->suppressed_mods;
+        del_mods(suppressed);
+        del_weak_mods(candidate->suppressed_mods);
+#ifndef NO_ACTION_ONESHOT
+        clear_oneshot_mods();
+#endif
+        register_code16(candidate->replacement);
+        return false;
+    }
+    return true;
+}
+
+void key_override_clear(void) {
+    active_override = NULL;
+    suppressed      = 0;
+}
+
+#endif
@@ -0,0 +1,28 @@
+// Compiles the keymap (KEYMAP_C, set by sim.mk) into the model. It is included rather than
+// compiled on its own, so that the sizes of its arrays are known here.
+
+#include KEYMAP_C
+
+#include "internal.h"
+
+uint8_t sim_layer_count(void) {
+    return ARRAY_SIZE(keymaps);
+}
+
+uint16_t sim_keycode_at(uint8_t layer, uint8_t row, uint8_t col) {
+    return keymap_key_to_keycode(layer, MAKE_KEYPOS(row, col));
+}
+
+uint16_t sim_combo_count(void) {
+#ifdef COMBO_ENABLE
+    return ARRAY_SIZE(key_combos);
+#else
+    return 0;
+#endif
+}
+
+#ifdef TAP_DANCE_ENABLE
+uint16_t sim_tap_dance_count(void) {
+    return ARRAY_SIZE(tap_dance_actions);
+}
+#endif
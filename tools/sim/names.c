@@ -0,0 +1,189 @@
+// Names of keycodes for the diagnostics of the tools.
+
+#include <stdio.h>
+#include <strings.h>
+
+#include "sim.h"
+
+static const char *basic_name(uint8_t code) {
+    static char buffer[8];
+    switch (code) {
+        case KC_NO:
+            return "KC_NO";
+        case KC_TRANSPARENT:
+            return "KC_TRNS";
+        case KC_A ... KC_Z:
+            snprintf(buffer, sizeof(buffer), "KC_%c", 'A' + (code - KC_A));
+            return buffer;
+        case KC_1 ... KC_9:
+            snprintf(buffer, sizeof(buffer), "KC_%c", '1' + (code - KC_1));
+            return buffer;
+        case KC_0:
+            return "KC_0";
+        case KC_ENTER:
+            return "KC_ENT";
+        case KC_ESCAPE:
+            return "KC_ESC";
+        case KC_BACKSPACE:
+            return "KC_BSPC";
+        case KC_TAB:
+            return "KC_TAB";
+        case KC_SPACE:
+            return "KC_SPC";
+        case KC_MINUS:
+            return "KC_MINS";
+        case KC_EQUAL:
+            return "KC_EQL";
+        case KC_LEFT_BRACKET:
+            return "KC_LBRC";
+        case KC_RIGHT_BRACKET:
+            return "KC_RBRC";
+        case KC_BACKSLASH:
+            return "KC_BSLS";
+        case KC_NONUS_HASH:
+            return "KC_NUHS";
+        case KC_SEMICOLON:
+            return "KC_SCLN";
+        case KC_QUOTE:
+            return "KC_QUOT";
+        case KC_GRAVE:
+            return "KC_GRV";
+        case KC_COMMA:
+            return "KC_COMM";
+        case KC_DOT:
+            return "KC_DOT";
+        case KC_SLASH:
+            return "KC_SLSH";
+        case KC_NONUS_BACKSLASH:
+            return "KC_NUBS";
+        case KC_DELETE:
+            return "KC_DEL";
+        case KC_LEFT:
+            return "KC_LEFT";
+        case KC_RIGHT:
+            return "KC_RGHT";
+        case KC_UP:
+            return "KC_UP";
+        case KC_DOWN:
+            return "KC_DOWN";
+        case KC_HOME:
+            return "KC_HOME";
+        case KC_END:
+            return "KC_END";
+        case KC_PAGE_UP:
+            return "KC_PGUP";
+        case KC_PAGE_DOWN:
+            return "KC_PGDN";
+        case KC_LEFT_CTRL:
+            return "KC_LCTL";
+        case KC_LEFT_SHIFT:
+            return "KC_LSFT";
+        case KC_LEFT_ALT:
+            return "KC_LALT";
+        case KC_LEFT_GUI:
+            return "KC_LGUI";
+        case KC_RIGHT_CTRL:
+            return "KC_RCTL";
+        case KC_RIGHT_SHIFT:
+            return "KC_RSFT";
+        case KC_RIGHT_ALT:
+            return "KC_RALT";
+        case KC_RIGHT_GUI:
+            return "KC_RGUI";
+        default:
+            snprintf(buffer, sizeof(buffer), "0x%02X", code);
+            return buffer;
+    }
+}
+
+// 5-bit modifiers as in `MOD_LCTL | MOD_LSFT`:
+static const char *mods_name(uint8_t mods) {
+    static char buffer[40];
+    static const char *names[] = {"CTL", "SFT", "ALT", "GUI"};
+    size_t             length  = 0;
+    buffer[0]                  = '\0';
+    for (uint8_t i = 0; i < 4; i++) {
+        if (mods & (1 << i)) {
+            length += snprintf(buffer + length, sizeof(buffer) - length, "%sMOD_%c%s", length ? "|" : "", (mods & 0x10) ? 'R' : 'L', names[i]);
+        }
+    }
+    return buffer;
+}
+
+const char *sim_keycode_name(uint16_t keycode) {
+    static char buffer[64];
+    switch (keycode) {
+        case QK_BASIC ... QK_BASIC_MAX:
+            return basic_name(keycode);
+        case QK_MODS ... QK_MODS_MAX:
+            snprintf(buffer, sizeof(buffer), "MODS(%s,", mods_name(QK_MODS_GET_MODS(keycode)));
+            snprintf(buffer + strlen(buffer), sizeof(buffer) - strlen(buffer), "%s)", basic_name(QK_MODS_GET_BASIC_KEYCODE(keycode)));
+            break;
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+            snprintf(buffer, sizeof(buffer), "MT(%s,", mods_name(QK_MOD_TAP_GET_MODS(keycode)));
+            snprintf(buffer + strlen(buffer), sizeof(buffer) - strlen(buffer), "%s)", basic_name(QK_MOD_TAP_GET_TAP_KEYCODE(keycode)));
+            break;
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+            snprintf(buffer, sizeof(buffer), "LT(%u,%s)", QK_LAYER_TAP_GET_LAYER(keycode), basic_name(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode)));
+            break;
+        case QK_TO ... QK_TO_MAX:
+            snprintf(buffer, sizeof(buffer), "TO(%u)", QK_TO_GET_LAYER(keycode));
+            break;
+        case QK_MOMENTARY ... QK_MOMENTARY_MAX:
+            snprintf(buffer, sizeof(buffer), "MO(%u)", QK_MOMENTARY_GET_LAYER(keycode));
+            break;
+        case QK_DEF_LAYER ... QK_DEF_LAYER_MAX:
+            snprintf(buffer, sizeof(buffer), "DF(%u)", QK_DEF_LAYER_GET_LAYER(keycode));
+            break;
+        case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:
+            snprintf(buffer, sizeof(buffer), "TG(%u)", QK_TOGGLE_LAYER_GET_LAYER(keycode));
+            break;
+        case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:
+            snprintf(buffer, sizeof(buffer), "OSL(%u)", QK_ONE_SHOT_LAYER_GET_LAYER(keycode));
+            break;
+        case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX:
+            snprintf(buffer, sizeof(buffer), "OSM(%s)", mods_name(QK_ONE_SHOT_MOD_GET_MODS(keycode)));
+            break;
+        case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:
+            snprintf(buffer, sizeof(buffer), "TD(%u)", QK_TAP_DANCE_GET_INDEX(keycode));
+            break;
+        case QK_KB ... QK_KB_MAX:
+            snprintf(buffer, sizeof(buffer), "QK_KB_%u", keycode - QK_KB);
+            break;
+        case QK_USER ... QK_USER_MAX:
+            snprintf(buffer, sizeof(buffer), "SAFE_RANGE+%u", keycode - QK_USER);
+            break;
+        default:
+            snprintf(buffer, sizeof(buffer), "0x%04X", keycode);
+            break;
+    }
+    return buffer;
+}
+
+// Layout positions of the matrix (see LAYOUT in zilpzalp.h), as the keymaps name them:
+static const char *position_names[MATRIX_ROWS][MATRIX_COLS] = {
+    {"L7", "L8", "L9", "LA"},
+    {"L4", "L5", "L6", "LB"},
+    {"LP", "L1", "L2", "L3"},
+    {"RS", "LS", "RE", "LE"},
+    {"RP", "R3", "R2", "R1"},
+    {"R6", "R5", "R4", "RB"},
+    {"R9", "R8", "R7", "RA"},
+};
+
+const char *sim_position_name(uint8_t row, uint8_t col) {
+    return row < MATRIX_ROWS && col < MATRIX_COLS ? position_names[row][col] : "??";
+}
+
+bool sim_parse_position(const char *name, uint8_t *row, uint8_t *col) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            if (strcasecmp(name, position_names[r][c]) == 0) {
+                *row = r;
+                *col = c;
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,170 @@
+// Repeat Key and Alternate Repeat Key, a simplified model of QMK's repeat_key.c and
+// process_repeat_key.c (0.22). The default alternates are limited to the navigation pairs, and
+// `get_repeat_key_count()` only tells repeats (> 0) from alternate repeats (< 0).
+
+#include "internal.h"
+
+#ifdef REPEAT_KEY_ENABLE
+
+static keyrecord_t last_record;
+static uint8_t     last_mods;
+static int8_t      last_repeat_count;
+static bool        repeating; // a repeated record is being processed
+
+__attribute__((weak)) bool remember_last_key_user(uint16_t keycode, keyrecord_t *record, uint8_t *remembered_mods) {
+    return true;
+}
+
+__attribute__((weak)) uint16_t get_alt_repeat_key_keycode_user(uint16_t keycode, uint8_t mods) {
+    return KC_TRANSPARENT;
+}
+
+uint16_t get_last_keycode(void) {
+    return last_record.keycode;
+}
+
+uint8_t get_last_mods(void) {
+    return last_mods;
+}
+
+void set_last_keycode(uint16_t keycode) {
+    last_record       = (keyrecord_t){.event = {.key = MAKE_KEYPOS(KEYLOC_COMBO, KEYLOC_COMBO), .type = COMBO_EVENT}, .keycode = keycode};
+    last_repeat_count = 0;
+}
+
+void set_last_mods(uint8_t mods) {
+    last_mods = mods;
+}
+
+int8_t get_repeat_key_count(void) {
+    return last_repeat_count;
+}
+
+static uint16_t tap_keycode(uint16_t keycode) {
+    if (IS_QK_MOD_TAP(keycode)) return QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    if (IS_QK_LAYER_TAP(keycode)) return QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    return keycode;
+}
+
+// The default alternates keep the last key's modifiers in the keycode (the user's do not get them).
+uint16_t get_alt_repeat_key_keycode(void) {
+    uint16_t alt = get_alt_repeat_key_keycode_user(last_record.keycode, last_mods);
+    if (alt != KC_TRANSPARENT) {
+        return alt;
+    }
+    uint8_t  mods    = ((last_mods & 0xF0) ? 0x10 : 0) | ((last_mods >> 4) | (last_mods & 0x0F));
+    uint16_t keycode = tap_keycode(last_record.keycode);
+    if (IS_QK_MODS(keycode)) {
+        mods |= QK_MODS_GET_MODS(keycode);
+        keycode = QK_MODS_GET_BASIC_KEYCODE(keycode);
+    }
+    static const uint16_t pairs[][2] = {
+        {KC_LEFT, KC_RIGHT}, {KC_UP, KC_DOWN}, {KC_HOME, KC_END}, {KC_PAGE_UP, KC_PAGE_DOWN},
+    };
+    for (uint8_t i = 0; i < ARRAY_SIZE(pairs); i++) {
+        if (keycode == pairs[i][0]) return pairs[i][1] | mods << 8;
+        if (keycode == pairs[i][1]) return pairs[i][0] | mods << 8;
+    }
+    return KC_NO;
+}
+
+// Processes `record` as if its key was pressed or released again, with `mods` as weak mods.
+static void invoke(keyrecord_t *record, const keyevent_t *event, uint8_t mods) {
+    record->event.pressed = event->pressed;
+    record->event.time    = event->time;
+    repeating             = true;
+    process_record_with_mods(record, event->pressed ? mods : 0);
+    repeating = false;
+    if (!event->pressed) {
+        unregister_weak_mods(mods);
+    }
+}
+
+void repeat_key_invoke(const keyevent_t *event) {
+    // The last key may change while the Repeat Key is held, so the release repeats the press.
+    static keyrecord_t registered_record;
+    static uint8_t     registered_mods;
+    if (event->pressed) {
+        if (!last_record.keycode) return;
+        if (last_repeat_count < 127) last_repeat_count++;
+        registered_record = last_record;
+        registered_mods   = last_mods;
+    } else if (!registered_record.keycode) {
+        return;
+    }
+    invoke(&registered_record, event, registered_mods);
+    if (!event->pressed) registered_record.keycode = KC_NO;
+}
+
+void alt_repeat_key_invoke(const keyevent_t *event) {
+    static keyrecord_t registered_record;
+    if (event->pressed) {
+        uint16_t alt = get_alt_repeat_key_keycode();
+        if (alt == KC_NO) return;
+        if (last_repeat_count > -127) last_repeat_count = last_repeat_count > 0 ? -1 : last_repeat_count - 1;
+        registered_record = (keyrecord_t){.event = {.key = MAKE_KEYPOS(KEYLOC_COMBO, KEYLOC_COMBO), .type = COMBO_EVENT}, .keycode = alt};
+    } else if (!registered_record.keycode) {
+        return;
+    }
+    invoke(&registered_record, event, 0);
+    if (!event->pressed) registered_record.keycode = KC_NO;
+}
+
+bool process_last_key(uint16_t keycode, keyrecord_t *record) {
+    if (repeating || !record->event.pressed) {
+        return true;
+    }
+    switch (keycode) {
+        case QK_REPEAT_KEY:
+        case QK_ALT_REPEAT_KEY:
+        case KC_NO:
+        case KC_LEFT_CTRL ... KC_RIGHT_GUI:
+        case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX:
+        case QK_TO ... QK_TO_MAX:
+        case QK_MOMENTARY ... QK_MOMENTARY_MAX:
+        case QK_DEF_LAYER ... QK_DEF_LAYER_MAX:
+        case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:
+        case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:
+        case QK_LAYER_TAP_TOGGLE ... QK_LAYER_TAP_TOGGLE_MAX:
+            return true;
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+            if (record->tap.count == 0) return true;
+            break;
+    }
+    uint8_t mods = get_mods() | get_weak_mods();
+#ifndef NO_ACTION_ONESHOT
+    mods |= get_oneshot_mods();
+#endif
+    if (remember_last_key_user(keycode, record, &mods)) {
+        last_record         = *record;
+        last_record.keycode = keycode;
+        last_mods           = mods;
+        last_repeat_count   = 0;
+    }
+    return true;
+}
+
+bool process_repeat_key(uint16_t keycode, keyrecord_t *record) {
+    if (repeating) {
+        return true;
+    }
+    if (keycode == QK_REPEAT_KEY) {
+        repeat_key_invoke(&record->event);
+        return false;
+    }
+    if (keycode == QK_ALT_REPEAT_KEY) {
+        alt_repeat_key_invoke(&record->event);
+        return false;
+    }
+    return true;
+}
+
+void repeat_key_clear(void) {
+    last_record       = (keyrecord_t){0};
+    last_mods         = 0;
+    last_repeat_count = 0;
+    repeating         = false;
+}
+
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+
+// Host-side model of the QMK core, driven by the tools in tools/. A keymap is compiled together
+// with zilpzalp.c, its features/ and tools/sim/*.c into one program per keymap (see sim.mk).
+//
+// The model runs the matrix scan loop on a virtual clock: the tool changes physical key states
+// with `sim_key()` and advances the clock with `sim_run_until()`. Everything the keyboard sends to
+// the host, and every tap-hold/combo/tap dance decision, is passed to the callbacks below.
+
+#include "sim_config.h"
+#include "quantum.h"
+
+// Everything the host sees, emitted whenever a part of it changes:
+typedef struct {
+    uint64_t time;     // µs
+    uint8_t  mods;     // keyboard report modifiers
+    uint8_t  keys[32]; // keyboard report keys, one bit per HID usage
+    uint16_t consumer; // consumer report usage, 0 if none
+    uint8_t  mouse;    // mouse buttons
+} sim_report_t;
+
+typedef enum {
+    SIM_TAP,       // key: tap-hold key, keycode: its keycode
+    SIM_HOLD,      // key: tap-hold key, keycode: its keycode
+    SIM_COMBO,     // key: last key of the combo, keycode: the combo's keycode
+    SIM_TAP_DANCE, // key: the TD key, keycode: TD(n), data: count | held << 7 | interrupted << 6
+} sim_decision_kind_t;
+
+typedef struct {
+    uint64_t            time; // µs
+    sim_decision_kind_t kind;
+    keypos_t            key;
+    uint16_t            keycode;
+    uint8_t             data;
+    uint32_t            press; // number of the physical press the decision is about (1-based)
+} sim_decision_t;
+
+typedef struct {
+    void (*report)(const sim_report_t *report, void *context);
+    void (*decision)(const sim_decision_t *decision, void *context);
+    void (*console)(const char *text, void *context);
+    void *context;
+} sim_callbacks_t;
+
+extern sim_callbacks_t sim_callbacks;
+
+// Restores the keymap's settings (the tools may change `sim_settings` before `sim_reset()`).
+void sim_default_settings(void);
+
+// Powers the keyboard on: clears all state, sets the clock to 0 and runs the init hooks.
+void sim_reset(void);
+
+// Changes the physical state of a key at the current time.
+void sim_key(uint8_t row, uint8_t col, bool pressed);
+
+// Runs matrix scans until the clock reaches `time` (µs).
+void     sim_run_until(uint64_t time);
+uint64_t sim_now(void);
+
+// The current host-visible state.
+const sim_report_t *sim_report(void);
+
+// Introspection of the keymap (implemented in keymap_glue.c):
+uint8_t  sim_layer_count(void);
+uint16_t sim_combo_count(void);
+uint16_t sim_keycode_at(uint8_t layer, uint8_t row, uint8_t col);
+
+// Event orders in which QMK 0.22 (and the model) may leave a modifier or layer on, counted since
+// `sim_reset()`:
+typedef struct {
+    // Presses that changed the source layer of their key while its previous release was still
+    // buffered (by tap-hold or combos). The release is looked up on the new layer (the source
+    // layers cache keeps one layer per key).
+    uint32_t source_layer_overwrites;
+    // Releases processed before the press of their key, which tap-hold still held in its waiting
+    // buffer after deciding about the tapping key, when both arrived in the same scan.
+    uint32_t early_releases;
+} sim_quirks_t;
+
+const sim_quirks_t *sim_quirks(void);
+
+// Name of a keycode for diagnostics, e.g. "MT(LGUI,KC_E)". Returns a static buffer.
+const char *sim_keycode_name(uint16_t keycode);
+
+// Names of the matrix positions as in the keymaps' layout comments: L1-L9, LA, LB, LP, LS, LE
+// and the same with R for the right half.
+const char *sim_position_name(uint8_t row, uint8_t col);
+bool        sim_parse_position(const char *name, uint8_t *row, uint8_t *col);
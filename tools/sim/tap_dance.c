@@ -0,0 +1,125 @@
+// Tap dance, ported from QMK's process_tap_dance.c (0.22).
+
+#include "internal.h"
+
+#ifdef TAP_DANCE_ENABLE
+
+#    ifdef TAPPING_TERM_PER_KEY
+#        define GET_TAP_DANCE_TERM(keycode, record) get_tapping_term(keycode, record)
+#    else
+#        define GET_TAP_DANCE_TERM(keycode, record) TAPPING_TERM
+#    endif
+
+static uint16_t active_td;
+static uint16_t last_tap_time;
+static keypos_t active_key; // position of the last press of a tap dance key
+
+void tap_dance_pair_on_each_tap(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    if (state->count == 2) {
+        register_code16(pair->kc2);
+        state->finished = true;
+    }
+}
+
+void tap_dance_pair_finished(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    register_code16(pair->kc1);
+}
+
+void tap_dance_pair_reset(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    if (state->count == 1) {
+        unregister_code16(pair->kc1);
+    } else if (state->count == 2) {
+        unregister_code16(pair->kc2);
+    }
+}
+
+static void call(tap_dance_action_t *action, tap_dance_user_fn_t fn) {
+    if (fn) fn(&action->state, action->user_data);
+}
+
+static void on_each_tap(tap_dance_action_t *action) {
+    action->state.count++;
+    action->state.weak_mods = get_mods() | get_weak_mods();
+    call(action, action->fn.on_each_tap);
+}
+
+static void on_reset(tap_dance_action_t *action) {
+    call(action, action->fn.on_reset);
+    del_weak_mods(action->state.weak_mods);
+    send_keyboard_report();
+    action->state = (tap_dance_state_t){0};
+}
+
+static void on_dance_finished(tap_dance_action_t *action, uint16_t keycode) {
+    if (!action->state.finished) {
+        action->state.finished = true;
+        sim_decide(SIM_TAP_DANCE, active_key, keycode, action->state.count | action->state.pressed << 7 | action->state.interrupted << 6);
+        add_weak_mods(action->state.weak_mods);
+        send_keyboard_report();
+        call(action, action->fn.on_dance_finished);
+    }
+    active_td = 0;
+    if (!action->state.pressed) {
+        // there will not be a release event, so reset now
+        on_reset(action);
+    }
+}
+
+bool preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed || !active_td || keycode == active_td) {
+        return false;
+    }
+    tap_dance_action_t *action         = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(active_td)];
+    action->state.interrupted          = true;
+    action->state.interrupting_keycode = keycode;
+    on_dance_finished(action, active_td);
+    // Weak mods of the tap dance must not affect the interrupting key.
+    clear_weak_mods();
+    return true;
+}
+
+bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!IS_QK_TAP_DANCE(keycode) || QK_TAP_DANCE_GET_INDEX(keycode) >= sim_tap_dance_count()) {
+        return true;
+    }
+    tap_dance_action_t *action = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(keycode)];
+    action->state.pressed      = record->event.pressed;
+    if (record->event.pressed) {
+        last_tap_time = timer_read();
+        active_key    = record->event.key;
+        on_each_tap(action);
+        if (action->state.finished) {
+            // finished by on_each_tap, e.g. the second tap of ACTION_TAP_DANCE_DOUBLE
+            sim_decide(SIM_TAP_DANCE, active_key, keycode, action->state.count | 1 << 7);
+        }
+        active_td = action->state.finished ? 0 : keycode;
+    } else {
+        call(action, action->fn.on_each_release);
+        if (action->state.finished) {
+            on_reset(action);
+        }
+    }
+    return true;
+}
+
+void tap_dance_task(void) {
+    if (!active_td || timer_elapsed(last_tap_time) <= GET_TAP_DANCE_TERM(active_td, &(keyrecord_t){0})) {
+        return;
+    }
+    tap_dance_action_t *action = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(active_td)];
+    if (!action->state.interrupted) {
+        on_dance_finished(action, active_td);
+    }
+}
+
+void tap_dance_clear(void) {
+    active_td = 0;
+    for (uint16_t index = 0; index < sim_tap_dance_count(); index++) {
+        tap_dance_actions[index].state = (tap_dance_state_t){0};
+    }
+}
+
+#endif
@@ -0,0 +1,308 @@
+// Tap-hold resolution, ported from QMK's action_tapping.c (0.22). Actions are looked up by keycode
+// instead of action codes, and PERMISSIVE_HOLD/HOLD_ON_OTHER_KEY_PRESS can be overridden at run
+// time through `sim_settings`.
+
+#include "internal.h"
+
+#define WAITING_BUFFER_SIZE 8
+
+static keyrecord_t tapping_key;
+static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE];
+static uint8_t     waiting_buffer_head, waiting_buffer_tail;
+
+__attribute__((weak)) uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    return TAPPING_TERM;
+}
+
+__attribute__((weak)) uint16_t get_quick_tap_term(uint16_t keycode, keyrecord_t *record) {
+    return QUICK_TAP_TERM;
+}
+
+__attribute__((weak)) bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) {
+    return false;
+}
+
+__attribute__((weak)) bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
+    return false;
+}
+
+#ifdef TAPPING_TERM_PER_KEY
+#    define GET_TAPPING_TERM(keycode, record) get_tapping_term(keycode, record)
+#else
+#    define GET_TAPPING_TERM(keycode, record) TAPPING_TERM
+#endif
+#ifdef QUICK_TAP_TERM_PER_KEY
+#    define GET_QUICK_TAP_TERM(keycode, record) get_quick_tap_term(keycode, record)
+#else
+#    define GET_QUICK_TAP_TERM(keycode, record) QUICK_TAP_TERM
+#endif
+
+static bool permissive_hold(uint16_t tapping_keycode) {
+    if (sim_settings.permissive_hold != SIM_KEYMAP) {
+        return sim_settings.permissive_hold;
+    }
+#if defined(PERMISSIVE_HOLD_PER_KEY)
+    return get_permissive_hold(tapping_keycode, &tapping_key);
+#elif defined(PERMISSIVE_HOLD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+static bool hold_on_other_key_press(uint16_t tapping_keycode, keyrecord_t *keyp) {
+    if (sim_settings.hold_on_other_key_press != SIM_KEYMAP) {
+        return sim_settings.hold_on_other_key_press;
+    }
+#if defined(HOLD_ON_OTHER_KEY_PRESS_PER_KEY)
+    return get_hold_on_other_key_press(tapping_keycode, keyp);
+#elif defined(HOLD_ON_OTHER_KEY_PRESS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#define IS_TAPPING() IS_EVENT(tapping_key.event)
+#define IS_TAPPING_PRESSED() (IS_TAPPING() && tapping_key.event.pressed)
+#define IS_TAPPING_RELEASED() (IS_TAPPING() && !tapping_key.event.pressed)
+#define IS_TAPPING_RECORD(r) (IS_TAPPING() && KEYEQ(tapping_key.event.key, (r)->event.key) && tapping_key.keycode == (r)->keycode)
+#define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16((e).time, tapping_key.event.time) < GET_TAPPING_TERM(get_record_keycode(&tapping_key, false), &tapping_key))
+#define WITHIN_QUICK_TAP_TERM(e) (TIMER_DIFF_16((e).time, tapping_key.event.time) < GET_QUICK_TAP_TERM(get_record_keycode(&tapping_key, false), &tapping_key))
+
+static bool is_tap_keycode(uint16_t keycode) {
+    switch (keycode) {
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+        case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:
+        case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_tap_record(keyrecord_t *record) {
+    if (IS_NOEVENT(record->event)) {
+        return false;
+    }
+    return is_tap_keycode(get_record_keycode(record, true));
+}
+
+// Whether the release of a key pressed before the tapping key has to wait for the tapping key
+// (modifiers and layers are retained until the end of the tapping).
+static bool is_retained_release(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, false);
+    switch (keycode) {
+        case KC_LEFT_CTRL ... KC_RIGHT_GUI:
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+        case QK_MOMENTARY ... QK_MOMENTARY_MAX:
+            return true;
+        case QK_MODS ... QK_MODS_MAX:
+            return QK_MODS_GET_BASIC_KEYCODE(keycode) == KC_NO || IS_MODIFIER_KEYCODE(QK_MODS_GET_BASIC_KEYCODE(keycode));
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+            return record->tap.count == 0 || IS_MODIFIER_KEYCODE(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+        default:
+            return false;
+    }
+}
+
+static bool waiting_buffer_enq(keyrecord_t record) {
+    if (IS_NOEVENT(record.event)) {
+        return true;
+    }
+    if ((waiting_buffer_head + 1) % WAITING_BUFFER_SIZE == waiting_buffer_tail) {
+        return false;
+    }
+    waiting_buffer[waiting_buffer_head] = record;
+    waiting_buffer_head                 = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
+    return true;
+}
+
+static bool waiting_buffer_typed(keyevent_t event) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+        if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed != waiting_buffer[i].event.pressed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Settles the tapping key as a tap if its release is already in the buffer.
+static void waiting_buffer_scan_tap(void) {
+    if (tapping_key.tap.count > 0 || !tapping_key.event.pressed) {
+        return;
+    }
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+        keyrecord_t *candidate = &waiting_buffer[i];
+        if (IS_EVENT(candidate->event) && KEYEQ(candidate->event.key, tapping_key.event.key) && !candidate->event.pressed && WITHIN_TAPPING_TERM(candidate->event)) {
+            tapping_key.tap.count = 1;
+            candidate->tap.count  = 1;
+            process_record(&tapping_key);
+            return;
+        }
+    }
+}
+
+// Releases the last tap of a multi-tap before a new tap key starts.
+static void release_last_tap(keyevent_t event) {
+    if (tapping_key.tap.count > 1) {
+        keyrecord_t release = {
+            .tap     = tapping_key.tap,
+            .event   = {.key = tapping_key.event.key, .time = event.time, .pressed = false, .type = tapping_key.event.type},
+            .keycode = tapping_key.keycode,
+        };
+        process_record(&release);
+    }
+}
+
+static void start_tapping(keyrecord_t *keyp) {
+    tapping_key = *keyp;
+    waiting_buffer_scan_tap();
+}
+
+static bool process_tapping(keyrecord_t *keyp) {
+    const keyevent_t event = keyp->event;
+
+    if (IS_TAPPING_PRESSED()) {
+        if (WITHIN_TAPPING_TERM(event)) {
+            if (IS_NOEVENT(event)) {
+                return true;
+            }
+            if (tapping_key.tap.count == 0) {
+                if (IS_TAPPING_RECORD(keyp) && !event.pressed) {
+                    // first tap
+                    tapping_key.tap.count = 1;
+                    process_record(&tapping_key);
+                    keyp->tap = tapping_key.tap;
+                    return false;
+                } else if (!event.pressed && waiting_buffer_typed(event) && permissive_hold(get_record_keycode(&tapping_key, false))) {
+                    // a key typed within the tapping term
+                    process_record(&tapping_key);
+                    tapping_key = (keyrecord_t){0};
+                    return false;
+                } else if (!event.pressed && !waiting_buffer_typed(event)) {
+                    // release of a key pressed before the tapping key
+                    if (is_retained_release(keyp)) {
+                        return false;
+                    }
+                    process_record(keyp);
+                    return true;
+                } else {
+                    if (event.pressed) {
+                        tapping_key.tap.interrupted = true;
+                        if (hold_on_other_key_press(get_record_keycode(&tapping_key, false), keyp)) {
+                            process_record(&tapping_key);
+                            tapping_key = (keyrecord_t){0};
+                        }
+                    }
+                    return false;
+                }
+            } else {
+                if (IS_TAPPING_RECORD(keyp) && !event.pressed) {
+                    // tap release
+                    keyp->tap = tapping_key.tap;
+                    process_record(keyp);
+                    tapping_key = *keyp;
+                    return true;
+                } else if (is_tap_record(keyp) && event.pressed) {
+                    release_last_tap(event);
+                    start_tapping(keyp);
+                    return true;
+                } else {
+                    process_record(keyp);
+                    return true;
+                }
+            }
+        } else {
+            // after the tapping term
+            if (tapping_key.tap.count == 0) {
+                process_record(&tapping_key);
+                tapping_key = (keyrecord_t){0};
+                return false;
+            } else {
+                if (IS_NOEVENT(event)) {
+                    return true;
+                }
+                if (IS_TAPPING_RECORD(keyp) && !event.pressed) {
+                    keyp->tap = tapping_key.tap;
+                    process_record(keyp);
+                    tapping_key = (keyrecord_t){0};
+                    return true;
+                } else if (is_tap_record(keyp) && event.pressed) {
+                    release_last_tap(event);
+                    start_tapping(keyp);
+                    return true;
+                } else {
+                    process_record(keyp);
+                    return true;
+                }
+            }
+        }
+    } else if (IS_TAPPING_RELEASED()) {
+        if (WITHIN_TAPPING_TERM(event)) {
+            if (IS_NOEVENT(event)) {
+                return true;
+            }
+            if (event.pressed) {
+                if (IS_TAPPING_RECORD(keyp)) {
+                    if (WITHIN_QUICK_TAP_TERM(event) && !tapping_key.tap.interrupted && tapping_key.tap.count > 0) {
+                        // sequential tap
+                        keyp->tap = tapping_key.tap;
+                        if (keyp->tap.count < 15) keyp->tap.count += 1;
+                        process_record(keyp);
+                        tapping_key = *keyp;
+                        return true;
+                    }
+                    tapping_key = *keyp;
+                    return true;
+                } else if (is_tap_record(keyp)) {
+                    start_tapping(keyp);
+                    return true;
+                } else {
+                    tapping_key.tap.interrupted = true;
+                    process_record(keyp);
+                    return true;
+                }
+            } else {
+                process_record(keyp);
+                return true;
+            }
+        } else {
+            // no sequential tap after the tapping term
+            tapping_key = (keyrecord_t){0};
+            return false;
+        }
+    } else {
+        // not tapping
+        if (event.pressed && is_tap_record(keyp)) {
+            start_tapping(keyp);
+            return true;
+        } else {
+            process_record(keyp);
+            return true;
+        }
+    }
+}
+
+void action_tapping_process(keyrecord_t record) {
+    if (!process_tapping(&record)) {
+        if (!waiting_buffer_enq(record)) {
+            // QMK clears everything when the buffer overflows
+            sim_print("sim: waiting buffer overflow\n");
+            clear_keyboard();
+            waiting_buffer_head = waiting_buffer_tail = 0;
+            tapping_key                               = (keyrecord_t){0};
+        }
+    }
+    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
+        if (!process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+            break;
+        }
+    }
+}
+
+void action_tapping_clear(void) {
+    tapping_key         = (keyrecord_t){0};
+    waiting_buffer_head = waiting_buffer_tail = 0;
+}
@@ -0,0 +1,298 @@
+// Runs scripted key-event timelines through the keymap compiled for the host and prints the
+// reports the host receives.
+//
+//   build/puq/simulate [options] [script...]
+//
+// A script holds one or more scenarios. Each starts on a powered-on keyboard with a clock at 0:
+//
+//   # Shift (held thumb) and E
+//   scenario shift-e
+//   0    down RS
+//   250  tap  R5        # pressed for 30 ms
+//   300  up   RS
+//
+// Times are in ms (fractions allowed) since the start of the scenario. Keys are the layout
+// positions of the keymaps' comments (L1-L9, LA, LB, LP, LS, LE and the same with R). `tap`
+// takes the time the key is held as an optional last argument. Without a file name the script is
+// read from stdin.
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sim.h"
+
+#define START_TIME 100000    // µs, the keyboard has been running for a while
+#define SETTLE_TIME 1000000  // µs after the last event, so that every pending decision times out
+#define TAP_DURATION 30000   // µs a `tap` holds its key by default
+
+typedef struct {
+    uint64_t time; // µs since the start of the scenario
+    uint8_t  row, col;
+    bool     pressed;
+} event_t;
+
+typedef struct {
+    char    *name;
+    event_t *events;
+    size_t   count, capacity;
+} scenario_t;
+
+typedef struct {
+    scenario_t *scenarios;
+    size_t      count, capacity;
+} script_t;
+
+typedef struct {
+    bool     print;
+    uint64_t start;
+    size_t   reports;
+    uint8_t  previous_keys[32];
+    uint8_t  previous_mouse;
+    uint16_t previous_consumer;
+    char     typed[4096]; // the host's view, as a space separated list of key presses
+    size_t   typed_length;
+} run_t;
+
+static void *grow(void *array, size_t *capacity, size_t size) {
+    *capacity = *capacity ? *capacity * 2 : 16;
+    array     = realloc(array, *capacity * size);
+    if (!array) {
+        perror("simulate");
+        exit(1);
+    }
+    return array;
+}
+
+static scenario_t *add_scenario(script_t *script, const char *name) {
+    if (script->count == script->capacity) {
+        script->scenarios = grow(script->scenarios, &script->capacity, sizeof(scenario_t));
+    }
+    scenario_t *scenario = &script->scenarios[script->count++];
+    *scenario            = (scenario_t){.name = strdup(name)};
+    return scenario;
+}
+
+static void add_event(scenario_t *scenario, event_t event) {
+    if (scenario->count == scenario->capacity) {
+        scenario->events = grow(scenario->events, &scenario->capacity, sizeof(event_t));
+    }
+    scenario->events[scenario->count++] = event;
+}
+
+static int compare_events(const void *a, const void *b) {
+    const event_t *first = a, *second = b;
+    if (first->time != second->time) {
+        return first->time < second->time ? -1 : 1;
+    }
+    return first < second ? -1 : first > second; // stable: keep the order of the script
+}
+
+static void read_script(FILE *file, const char *file_name, script_t *script) {
+    char        line[256];
+    unsigned    number   = 0;
+    scenario_t *scenario = NULL;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        char  *words[4];
+        size_t count = 0;
+        for (char *word = strtok(line, " \t"); word && count < ARRAY_SIZE(words); word = strtok(NULL, " \t")) {
+            words[count++] = word;
+        }
+        if (count == 0) {
+            continue;
+        }
+        if (strcmp(words[0], "scenario") == 0 && count == 2) {
+            scenario = add_scenario(script, words[1]);
+            continue;
+        }
+        char   *end;
+        double  ms = strtod(words[0], &end);
+        uint8_t row, col;
+        if (*end != '\0' || ms < 0 || count < 3 || !sim_parse_position(words[2], &row, &col)) {
+            fprintf(stderr, "simulate: %s:%u: expected 'scenario NAME' or 'MS down|up|tap KEY [MS]'\n", file_name, number);
+            exit(2);
+        }
+        if (!scenario) {
+            scenario = add_scenario(script, file_name);
+        }
+        uint64_t time = ms * 1000;
+        if (strcmp(words[1], "down") == 0 && count == 3) {
+            add_event(scenario, (event_t){.time = time, .row = row, .col = col, .pressed = true});
+        } else if (strcmp(words[1], "up") == 0 && count == 3) {
+            add_event(scenario, (event_t){.time = time, .row = row, .col = col, .pressed = false});
+        } else if (strcmp(words[1], "tap") == 0) {
+            uint64_t duration = count == 4 ? strtod(words[3], NULL) * 1000 : TAP_DURATION;
+            add_event(scenario, (event_t){.time = time, .row = row, .col = col, .pressed = true});
+            add_event(scenario, (event_t){.time = time + duration, .row = row, .col = col, .pressed = false});
+        } else {
+            fprintf(stderr, "simulate: %s:%u: unknown action '%s'\n", file_name, number, words[1]);
+            exit(2);
+        }
+    }
+    for (size_t i = 0; i < script->count; i++) {
+        qsort(script->scenarios[i].events, script->scenarios[i].count, sizeof(event_t), compare_events);
+    }
+}
+
+static void append_typed(run_t *run, const char *token) {
+    size_t length = strlen(token);
+    if (run->typed_length + length + 2 < sizeof(run->typed)) {
+        if (run->typed_length) {
+            run->typed[run->typed_length++] = ' ';
+        }
+        memcpy(run->typed + run->typed_length, token, length + 1);
+        run->typed_length += length;
+    }
+}
+
+// Modifiers without left/right, e.g. "S-" or "C-S-".
+static const char *mods_prefix(uint8_t mods) {
+    static char prefix[16];
+    mods = (mods | mods >> 4) & 0x0F;
+    snprintf(prefix, sizeof(prefix), "%s%s%s%s", mods & 1 ? "C-" : "", mods & 2 ? "S-" : "", mods & 4 ? "A-" : "", mods & 8 ? "G-" : "");
+    return prefix;
+}
+
+static void on_report(const sim_report_t *report, void *context) {
+    run_t *run = context;
+    char   token[64], state[512] = "";
+    size_t length = 0;
+    run->reports++;
+    for (uint16_t usage = KC_A; usage < 256; usage++) {
+        bool now = report->keys[usage >> 3] & (1 << (usage & 7)), before = run->previous_keys[usage >> 3] & (1 << (usage & 7));
+        if (now && !before) {
+            snprintf(token, sizeof(token), "%s%s", mods_prefix(report->mods), sim_keycode_name(usage));
+            append_typed(run, token);
+        }
+        if (now && length < sizeof(state)) {
+            length += snprintf(state + length, sizeof(state) - length, " %s", sim_keycode_name(usage));
+        }
+    }
+    if (report->consumer && report->consumer != run->previous_consumer) {
+        snprintf(token, sizeof(token), "consumer:%04X", report->consumer);
+        append_typed(run, token);
+    }
+    for (uint8_t button = 0; button < 5; button++) {
+        if ((report->mouse & ~run->previous_mouse) & (1 << button)) {
+            snprintf(token, sizeof(token), "BTN%u", button + 1);
+            append_typed(run, token);
+        }
+    }
+    if (run->print) {
+        printf("%10.3f ms  %-8s%s", (report->time - run->start) / 1e3, *mods_prefix(report->mods) ? mods_prefix(report->mods) : "-", *state ? state : " -");
+        if (report->consumer) printf(" consumer:%04X", report->consumer);
+        if (report->mouse) printf(" mouse:%02X", report->mouse);
+        printf("\n");
+    }
+    memcpy(run->previous_keys, report->keys, sizeof(run->previous_keys));
+    run->previous_consumer = report->consumer;
+    run->previous_mouse    = report->mouse;
+}
+
+static void on_console(const char *text, void *context) {}
+
+static void run_scenario(const scenario_t *scenario, run_t *run) {
+    bool print = run->print;
+    *run       = (run_t){.print = print};
+    sim_callbacks = (sim_callbacks_t){.report = on_report, .console = on_console, .context = run};
+    sim_reset();
+    sim_run_until(START_TIME);
+    run->start = sim_now();
+    for (size_t i = 0; i < scenario->count; i++) {
+        const event_t *event = &scenario->events[i];
+        sim_run_until(run->start + event->time);
+        sim_key(event->row, event->col, event->pressed);
+    }
+    sim_run_until(sim_now() + SETTLE_TIME);
+}
+
+static unsigned parse_number(const char *value) {
+    char         *end;
+    unsigned long number = strtoul(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || number > 0xFFFF) {
+        fprintf(stderr, "simulate: invalid number '%s'\n", value);
+        exit(2);
+    }
+    return number;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: simulate [options] [script...]\n"
+            "  --tapping-term MS\n"
+            "  --combo-term MS\n"
+            "  --scan-interval US     time between two matrix scans (default 500)\n"
+            "  -q, --quiet            print only what was typed in each scenario\n"
+            "  -r, --repeat N         run the scenarios N times and print the throughput\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"tapping-term", required_argument, NULL, 't'},
+        {"combo-term", required_argument, NULL, 'c'},
+        {"scan-interval", required_argument, NULL, 's'},
+        {"quiet", no_argument, NULL, 'q'},
+        {"repeat", required_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0},
+    };
+    sim_default_settings();
+    bool     quiet   = false;
+    unsigned repeats = 0;
+    int      option;
+    while ((option = getopt_long(argc, argv, "qr:", options, NULL)) != -1) {
+        switch (option) {
+            // clang-format off
+            case 't': sim_settings.tapping_term = parse_number(optarg); break;
+            case 'c': sim_settings.combo_term = parse_number(optarg); break;
+            case 's': sim_settings.scan_interval = parse_number(optarg); break;
+            case 'q': quiet = true; break;
+            case 'r': repeats = parse_number(optarg); break;
+            default: usage();
+            // clang-format on
+        }
+    }
+
+    script_t script = {0};
+    if (optind == argc) {
+        read_script(stdin, "stdin", &script);
+    }
+    for (int i = optind; i < argc; i++) {
+        FILE *file = fopen(argv[i], "r");
+        if (!file) {
+            fprintf(stderr, "simulate: %s: %s\n", argv[i], strerror(errno));
+            return 1;
+        }
+        read_script(file, argv[i], &script);
+        fclose(file);
+    }
+
+    run_t run = {0};
+    for (size_t i = 0; i < script.count; i++) {
+        run.print = !quiet;
+        if (!quiet) printf("scenario %s\n", script.scenarios[i].name);
+        run_scenario(&script.scenarios[i], &run);
+        printf("%s: %s\n", quiet ? script.scenarios[i].name : "typed", run.typed_length ? run.typed : "-");
+    }
+
+    if (repeats) {
+        size_t          events = 0;
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (unsigned repeat = 0; repeat < repeats; repeat++) {
+            for (size_t i = 0; i < script.count; i++) {
+                run.print = false;
+                run_scenario(&script.scenarios[i], &run);
+                events += script.scenarios[i].count;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+        fprintf(stderr, "%zu scenarios, %zu key events in %.3f s: %.0f scenarios/s\n", script.count * repeats, events, seconds, script.count * repeats / seconds);
+    }
+    return 0;
+}
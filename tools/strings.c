@@ -0,0 +1,95 @@
+// Counts the keyboard reports that strings take with SEND_STRING and with `send_string_packed()`
+// (see features/packed_string.h), and checks that the host receives the same text from both.
+//
+//   build/aptmak/strings [string...]
+//
+// Without arguments, a few typical text expansions are measured. The keymap needs
+// PACKED_STRING_ENABLE.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+#ifdef PACKED_STRING_ENABLE
+#    include "features/packed_string.h"
+#endif
+
+typedef struct {
+    size_t  reports;
+    char    text[256]; // the characters the host received
+    size_t  length;
+    uint8_t previous_keys[32];
+} run_t;
+
+static const char *default_strings[] = {
+    "sch",
+    "the quick brown fox jumps over the lazy dog",
+    "Mit freundlichen Gruessen",
+    "Hello, World!",
+    "mississippi",
+    "https://docs.qmk.fm/#/feature_send_string",
+};
+
+// The character of a new key press, as the host's US layout would produce it.
+static char character_of(uint8_t usage, uint8_t mods) {
+    bool shifted = mods & (MOD_BIT(KC_LEFT_SHIFT) | MOD_BIT(KC_RIGHT_SHIFT));
+    for (uint8_t c = 1; c < 128; c++) {
+        if (ascii_to_keycode_lut[c] == usage && PGM_LOADBIT(ascii_to_shift_lut, c) == shifted) {
+            return c;
+        }
+    }
+    return '?';
+}
+
+static void on_report(const sim_report_t *report, void *context) {
+    run_t *run = context;
+    run->reports++;
+    for (uint16_t usage = KC_A; usage < 256; usage++) {
+        bool down = report->keys[usage >> 3] & (1 << (usage & 7));
+        bool was  = run->previous_keys[usage >> 3] & (1 << (usage & 7));
+        if (down && !was && run->length + 1 < sizeof(run->text)) {
+            run->text[run->length++] = character_of(usage, report->mods);
+        }
+    }
+    memcpy(run->previous_keys, report->keys, sizeof(run->previous_keys));
+}
+
+static void run_string(const char *string, bool packed, run_t *run) {
+    *run                 = (run_t){0};
+    sim_callbacks.report = on_report;
+    sim_callbacks.context = run;
+    sim_reset();
+#ifdef PACKED_STRING_ENABLE
+    if (packed) {
+        send_string_packed(string);
+        return;
+    }
+#endif
+    send_string(string);
+}
+
+int main(int argc, char **argv) {
+#ifndef PACKED_STRING_ENABLE
+    fprintf(stderr, "strings: the keymap does not enable PACKED_STRING_ENABLE\n");
+    return 1;
+#endif
+    const char **strings = argc > 1 ? (const char **)argv + 1 : default_strings;
+    size_t       count   = argc > 1 ? (size_t)argc - 1 : ARRAY_SIZE(default_strings);
+    size_t       total_plain = 0, total_packed = 0;
+    bool         ok = true;
+
+    sim_default_settings();
+    printf("%7s %7s %7s  %s\n", "chars", "plain", "packed", "string");
+    for (size_t i = 0; i < count; i++) {
+        run_t plain, packed;
+        run_string(strings[i], false, &plain);
+        run_string(strings[i], true, &packed);
+        bool same = plain.length == packed.length && memcmp(plain.text, packed.text, plain.length) == 0;
+        printf("%7zu %7zu %7zu  %s%s\n", strlen(strings[i]), plain.reports, packed.reports, strings[i], same ? "" : "  (the host receives other text!)");
+        total_plain += plain.reports;
+        total_packed += packed.reports;
+        ok &= same;
+    }
+    printf("reports: %zu plain, %zu packed (%.1f times fewer)\n", total_plain, total_packed, total_packed ? (double)total_plain / total_packed : 0);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,592 @@
+// Replays recorded traces with every combination of a range of settings and lists the ones that
+// are not beaten in both output errors and lag (the Pareto frontier), followed by the lines for
+// the keymap's config.h that select the best of them.
+//
+//   build/puq/sweep [options] trace...
+//
+// The traces are those of `replay`: the console output of TRACE_ENABLE, or a key log converted
+// with `keylog --replay`. The output a trace is meant to type is read from a file of the same
+// name with `.expected` appended, which holds the host's key presses like `--typed` prints them
+// (e.g. the output with the keymap's settings, with the presses that misfired corrected). Without
+// such a file, the output with the keymap's settings counts as intended, so the sweep finds the
+// settings that type the same with less lag.
+//
+// For each setting:
+//   edits  key presses of the host to delete or insert to get the intended output
+//   lag    time from the last physical press to each key the host receives
+//
+// The settings are evaluated by worker processes, one per CPU by default, since the model of the
+// keyboard is a single global state.
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+#define START_TIME 100000   // µs, the keyboard has been running for a while when the trace starts
+#define SETTLE_TIME 5000000 // µs after the last event, so that every pending decision times out
+#define MAX_VALUES 64       // values of one setting
+#define MAX_WORKERS 256
+#define MAX_EDITS 10000 // edit distances are not computed beyond this
+
+typedef struct {
+    uint64_t time; // µs
+    uint8_t  key;  // row << 4 | col
+    bool     pressed;
+} event_t;
+
+typedef struct {
+    uint32_t code; // a key press of the host, see `token_code()`
+    uint32_t lag;  // µs since the last physical press
+} token_t;
+
+typedef struct {
+    token_t *tokens;
+    size_t   count, capacity;
+} tokens_t;
+
+typedef struct {
+    char    *name;
+    event_t *events;
+    size_t   count, capacity;
+    tokens_t intended;
+    bool     expected; // the intended output is from a `.expected` file
+} trace_t;
+
+typedef struct {
+    tokens_t tokens;
+    uint64_t last_press; // µs
+    uint8_t  previous_keys[32];
+    uint16_t previous_consumer;
+    uint8_t  previous_mouse;
+} run_t;
+
+typedef struct {
+    sim_settings_t settings;
+    size_t         edits;
+    size_t         outputs;
+    double         mean_lag; // ms
+    double         p90_lag;  // ms
+} result_t;
+
+typedef struct {
+    uint16_t values[MAX_VALUES];
+    uint8_t  count;
+} values_t;
+
+static trace_t *traces;
+static size_t   trace_count;
+static bool     quick_tap_follows; // QUICK_TAP_TERM is not set, so it is the tapping term
+
+static void *grow(void *array, size_t *capacity, size_t size) {
+    *capacity = *capacity ? *capacity * 2 : 256;
+    array     = realloc(array, *capacity * size);
+    if (!array) {
+        perror("sweep");
+        exit(1);
+    }
+    return array;
+}
+
+// A key press of the host: the usage with the modifiers (without left/right) above it, a consumer
+// usage or a mouse button.
+static uint32_t token_code(uint8_t usage, uint8_t mods) {
+    return ((mods | mods >> 4) & 0x0F) << 8 | usage;
+}
+#define CONSUMER_TOKEN 0x10000
+#define BUTTON_TOKEN 0x20000
+
+static void push_token(tokens_t *tokens, uint32_t code, uint32_t lag) {
+    if (tokens->count == tokens->capacity) {
+        tokens->tokens = grow(tokens->tokens, &tokens->capacity, sizeof(token_t));
+    }
+    tokens->tokens[tokens->count++] = (token_t){.code = code, .lag = lag};
+}
+
+static void token_name(uint32_t code, char *buffer, size_t size) {
+    uint8_t mods = code >> 8 & 0x0F;
+    if (code & CONSUMER_TOKEN) {
+        snprintf(buffer, size, "consumer:%04X", code & 0xFFFF);
+    } else if (code & BUTTON_TOKEN) {
+        snprintf(buffer, size, "BTN%u", code & 0xFF);
+    } else {
+        snprintf(buffer, size, "%s%s%s%s%s", mods & 1 ? "C-" : "", mods & 2 ? "S-" : "", mods & 4 ? "A-" : "", mods & 8 ? "G-" : "", sim_keycode_name(code & 0xFF));
+    }
+}
+
+static bool parse_token(const char *name, uint32_t *code) {
+    unsigned value;
+    uint8_t  mods = 0;
+    if (sscanf(name, "consumer:%x", &value) == 1) {
+        *code = CONSUMER_TOKEN | (value & 0xFFFF);
+        return true;
+    }
+    if (sscanf(name, "BTN%u", &value) == 1) {
+        *code = BUTTON_TOKEN | (value & 0xFF);
+        return true;
+    }
+    for (; name[0] && name[1] == '-'; name += 2) {
+        const char *prefixes = "CSAG", *prefix = strchr(prefixes, name[0]);
+        if (!prefix) return false;
+        mods |= 1 << (prefix - prefixes);
+    }
+    for (uint16_t usage = 0; usage < 256; usage++) {
+        if (strcmp(sim_keycode_name(usage), name) == 0) {
+            *code = token_code(usage, mods);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void on_report(const sim_report_t *report, void *context) {
+    run_t   *run = context;
+    uint32_t lag = report->time - run->last_press;
+    for (uint16_t usage = KC_A; usage < 256; usage++) {
+        bool now = report->keys[usage >> 3] & (1 << (usage & 7)), before = run->previous_keys[usage >> 3] & (1 << (usage & 7));
+        if (now && !before) {
+            push_token(&run->tokens, token_code(usage, report->mods), lag);
+        }
+    }
+    if (report->consumer && report->consumer != run->previous_consumer) {
+        push_token(&run->tokens, CONSUMER_TOKEN | report->consumer, lag);
+    }
+    for (uint8_t button = 0; button < 5; button++) {
+        if ((report->mouse & ~run->previous_mouse) & (1 << button)) {
+            push_token(&run->tokens, BUTTON_TOKEN | (button + 1), lag);
+        }
+    }
+    memcpy(run->previous_keys, report->keys, sizeof(run->previous_keys));
+    run->previous_consumer = report->consumer;
+    run->previous_mouse    = report->mouse;
+}
+
+static void on_console(const char *text, void *context) {}
+
+static void run_trace(const trace_t *trace, run_t *run) {
+    tokens_t tokens = run->tokens;
+    *run            = (run_t){.tokens = tokens};
+    run->tokens.count = 0;
+    sim_callbacks     = (sim_callbacks_t){.report = on_report, .console = on_console, .context = run};
+    sim_reset();
+    for (size_t i = 0; i < trace->count; i++) {
+        const event_t *event = &trace->events[i];
+        sim_run_until(event->time);
+        if (event->pressed) {
+            run->last_press = sim_now();
+        }
+        sim_key(event->key >> 4, event->key & 0x0F, event->pressed);
+    }
+    sim_run_until(sim_now() + SETTLE_TIME);
+}
+
+// Insertions and deletions that turn `a` into `b` (Myers' O(ND) algorithm), at most `limit`.
+static size_t edit_distance(const token_t *a, size_t n, const token_t *b, size_t m, size_t limit) {
+    while (n && m && a[0].code == b[0].code) a++, b++, n--, m--;
+    while (n && m && a[n - 1].code == b[m - 1].code) n--, m--;
+    size_t max = n + m < limit ? n + m : limit;
+    long  *v   = calloc(2 * max + 3, sizeof(long)), offset = max + 1;
+    for (long d = 0; d <= (long)max; d++) {
+        for (long k = -d; k <= d; k += 2) {
+            long x = k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]) ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            long y = x - k;
+            while (x < (long)n && y < (long)m && a[x].code == b[y].code) x++, y++;
+            v[offset + k] = x;
+            if (x >= (long)n && y >= (long)m) {
+                free(v);
+                return d;
+            }
+        }
+    }
+    free(v);
+    return limit;
+}
+
+static int compare_lags(const void *a, const void *b) {
+    uint32_t first = *(const uint32_t *)a, second = *(const uint32_t *)b;
+    return first < second ? -1 : first > second;
+}
+
+static void evaluate(const sim_settings_t *settings, result_t *result) {
+    static run_t  run;
+    static size_t lag_count, lag_capacity;
+    static uint32_t *lags;
+    sim_settings = *settings;
+    *result      = (result_t){.settings = *settings};
+    lag_count    = 0;
+    double total = 0;
+    for (size_t i = 0; i < trace_count; i++) {
+        run_trace(&traces[i], &run);
+        result->edits += edit_distance(run.tokens.tokens, run.tokens.count, traces[i].intended.tokens, traces[i].intended.count, MAX_EDITS);
+        for (size_t j = 0; j < run.tokens.count; j++) {
+            if (lag_count == lag_capacity) {
+                lags = grow(lags, &lag_capacity, sizeof(uint32_t));
+            }
+            lags[lag_count++] = run.tokens.tokens[j].lag;
+            total += run.tokens.tokens[j].lag;
+        }
+    }
+    result->outputs = lag_count;
+    if (lag_count) {
+        qsort(lags, lag_count, sizeof(uint32_t), compare_lags);
+        result->mean_lag = total / lag_count / 1e3;
+        result->p90_lag  = lags[(lag_count - 1) * 90 / 100] / 1e3;
+    }
+}
+
+// Evaluates all settings in worker processes, each taking every `workers`-th one.
+static void evaluate_all(const sim_settings_t *settings, result_t *results, size_t count, unsigned workers) {
+    int   fds[MAX_WORKERS];
+    pid_t pids[MAX_WORKERS];
+    for (unsigned worker = 0; worker < workers; worker++) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0 || (pids[worker] = fork()) < 0) {
+            perror("sweep");
+            exit(1);
+        }
+        if (pids[worker] == 0) {
+            close(pipe_fds[0]);
+            for (size_t i = worker; i < count; i += workers) {
+                result_t result;
+                evaluate(&settings[i], &result);
+                if (write(pipe_fds[1], &result, sizeof(result)) != sizeof(result)) {
+                    _exit(1);
+                }
+            }
+            _exit(0);
+        }
+        close(pipe_fds[1]);
+        fds[worker] = pipe_fds[0];
+    }
+    for (unsigned worker = 0; worker < workers; worker++) {
+        FILE *file = fdopen(fds[worker], "r");
+        for (size_t i = worker; i < count; i += workers) {
+            if (fread(&results[i], sizeof(result_t), 1, file) != 1) {
+                fprintf(stderr, "sweep: a worker process failed\n");
+                exit(1);
+            }
+        }
+        fclose(file);
+        waitpid(pids[worker], NULL, 0);
+    }
+}
+
+// Reads the key events of a trace like `replay` does. Timestamps wrap at 32 bits.
+static void read_trace(FILE *file, trace_t *trace) {
+    char     line[256];
+    uint32_t previous = 0;
+    uint64_t time     = START_TIME;
+    bool     first    = true;
+    while (fgets(line, sizeof(line), file)) {
+        char         *text = strstr(line, "trace ");
+        unsigned long raw_time;
+        unsigned      kind, key, keycode;
+        if (!text || sscanf(text, "trace %lx %u %x %x", &raw_time, &kind, &key, &keycode) != 4) {
+            continue;
+        }
+        if (!first) {
+            time += (uint32_t)((uint32_t)raw_time - previous);
+        }
+        previous = raw_time;
+        first    = false;
+        if (kind > 1 || key == 0xFF) {
+            continue; // a decision
+        }
+        if (trace->count == trace->capacity) {
+            trace->events = grow(trace->events, &trace->capacity, sizeof(event_t));
+        }
+        trace->events[trace->count++] = (event_t){.time = time, .key = key, .pressed = kind == 0};
+    }
+}
+
+static bool read_expected(trace_t *trace) {
+    char path[4096], word[64];
+    snprintf(path, sizeof(path), "%s.expected", trace->name);
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    while (fscanf(file, "%63s", word) == 1) {
+        uint32_t code;
+        if (!parse_token(word, &code)) {
+            fprintf(stderr, "sweep: %s: unknown key press '%s'\n", path, word);
+            exit(2);
+        }
+        push_token(&trace->intended, code, 0);
+    }
+    fclose(file);
+    return true;
+}
+
+static void parse_range(const char *value, values_t *values) {
+    unsigned first, last, step = 1;
+    int      fields = sscanf(value, "%u:%u:%u", &first, &last, &step);
+    if (fields == 1) {
+        last = first;
+    }
+    if (fields < 1 || step == 0 || last < first || last > 0xFFFF || (last - first) / step >= MAX_VALUES) {
+        fprintf(stderr, "sweep: expected MS or MIN:MAX[:STEP] with at most %u values instead of '%s'\n", MAX_VALUES, value);
+        exit(2);
+    }
+    values->count = 0;
+    for (unsigned ms = first; ms <= last; ms += step) {
+        values->values[values->count++] = ms;
+    }
+}
+
+static void parse_toggles(const char *value, values_t *values) {
+    char list[64];
+    snprintf(list, sizeof(list), "%s", value);
+    values->count = 0;
+    for (char *word = strtok(list, ","); word; word = strtok(NULL, ",")) {
+        if (strcmp(word, "keymap") == 0) {
+            values->values[values->count++] = (uint16_t)SIM_KEYMAP;
+        } else if (strcmp(word, "on") == 0 || strcmp(word, "off") == 0) {
+            values->values[values->count++] = strcmp(word, "on") == 0;
+        } else {
+            fprintf(stderr, "sweep: expected a list of on, off and keymap instead of '%s'\n", value);
+            exit(2);
+        }
+    }
+}
+
+static const char *toggle_name(int8_t value) {
+    return value == SIM_KEYMAP ? "keymap" : value ? "on" : "off";
+}
+
+// Whether `get_combo_term()` gives some combos a term of their own.
+static bool has_own_combo_terms(void) {
+#if defined(COMBO_ENABLE) && defined(COMBO_TERM_PER_COMBO)
+    for (uint16_t index = 0; index < sim_combo_count(); index++) {
+        if (get_combo_term(index, &key_combos[index]) != COMBO_TERM) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+static void print_result(const char *label, const result_t *result) {
+    char per_combo[8] = "-";
+    if (result->settings.per_combo_term) {
+        snprintf(per_combo, sizeof(per_combo), "%u", result->settings.per_combo_term);
+    }
+    printf("%-8s %7u %6u %9s %10s %10s %7zu %8.1f %8.1f\n", label, result->settings.tapping_term, result->settings.combo_term, per_combo, toggle_name(result->settings.permissive_hold), toggle_name(result->settings.hold_on_other_key_press), result->edits, result->mean_lag, result->p90_lag);
+}
+
+static int compare_results(const void *a, const void *b) {
+    const result_t *first = a, *second = b;
+    if (first->edits != second->edits) {
+        return first->edits < second->edits ? -1 : 1;
+    }
+    return first->mean_lag < second->mean_lag ? -1 : first->mean_lag > second->mean_lag;
+}
+
+static void print_toggle(const char *name, int8_t value, bool per_key) {
+    if (value == SIM_KEYMAP) {
+        return;
+    }
+    if (value) {
+        printf("#define %s\n", name);
+    } else {
+        printf("// remove %s\n", name);
+    }
+    if (per_key) {
+        printf("// remove %s_PER_KEY: the sweep applied the setting to every key\n", name);
+    }
+}
+
+static void print_config(const result_t *best, const result_t *keymap) {
+    bool permissive_per_key = false, hold_per_key = false;
+#ifdef PERMISSIVE_HOLD_PER_KEY
+    permissive_per_key = true;
+#endif
+#ifdef HOLD_ON_OTHER_KEY_PRESS_PER_KEY
+    hold_per_key = true;
+#endif
+    printf("\n// %zu edits, %.1f ms mean lag (the keymap's settings: %zu edits, %.1f ms)\n", best->edits, best->mean_lag, keymap->edits, keymap->mean_lag);
+    printf("#define TAPPING_TERM %u\n", best->settings.tapping_term);
+#ifdef COMBO_ENABLE
+    printf("#define COMBO_TERM %u\n", best->settings.combo_term);
+#endif
+    if (best->settings.per_combo_term) {
+        printf("// get_combo_term(): return %u for the combos with a term of their own\n", best->settings.per_combo_term);
+    }
+    print_toggle("PERMISSIVE_HOLD", best->settings.permissive_hold, permissive_per_key);
+    print_toggle("HOLD_ON_OTHER_KEY_PRESS", best->settings.hold_on_other_key_press, hold_per_key);
+}
+
+static unsigned parse_number(const char *value) {
+    char         *end;
+    unsigned long number = strtoul(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || number > 0xFFFF) {
+        fprintf(stderr, "sweep: invalid number '%s'\n", value);
+        exit(2);
+    }
+    return number;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: sweep [options] trace...\n"
+            "  --tapping-term RANGE       MS or MIN:MAX[:STEP] (default 150:250:25)\n"
+            "  --combo-term RANGE         (default 40:120:20)\n"
+            "  --per-combo-term RANGE     for the combos with a term of their own (default 10:40:10)\n"
+            "  --permissive-hold LIST     of on, off and keymap (default keymap,on,off)\n"
+            "  --hold-on-other-key-press LIST\n"
+            "  --typed                    print the output with the keymap's settings\n"
+            "  -j, --jobs N               worker processes (default: one per CPU)\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"tapping-term", required_argument, NULL, 't'},
+        {"combo-term", required_argument, NULL, 'c'},
+        {"per-combo-term", required_argument, NULL, 'C'},
+        {"permissive-hold", required_argument, NULL, 'p'},
+        {"hold-on-other-key-press", required_argument, NULL, 'o'},
+        {"typed", no_argument, NULL, 'T'},
+        {"jobs", required_argument, NULL, 'j'},
+        {NULL, 0, NULL, 0},
+    };
+    sim_default_settings();
+    sim_settings_t keymap_settings = sim_settings;
+    quick_tap_follows              = keymap_settings.quick_tap_term == keymap_settings.tapping_term;
+    values_t tapping_terms, combo_terms, per_combo_terms, permissive_holds, hold_on_other_key_presses;
+    parse_range("150:250:25", &tapping_terms);
+    parse_range("40:120:20", &combo_terms);
+    parse_range("10:40:10", &per_combo_terms);
+    parse_toggles("keymap,on,off", &permissive_holds);
+    parse_toggles("keymap,on,off", &hold_on_other_key_presses);
+    bool     typed   = false;
+    unsigned workers = sysconf(_SC_NPROCESSORS_ONLN);
+    int      option;
+    while ((option = getopt_long(argc, argv, "j:", options, NULL)) != -1) {
+        switch (option) {
+            // clang-format off
+            case 't': parse_range(optarg, &tapping_terms); break;
+            case 'c': parse_range(optarg, &combo_terms); break;
+            case 'C': parse_range(optarg, &per_combo_terms); break;
+            case 'p': parse_toggles(optarg, &permissive_holds); break;
+            case 'o': parse_toggles(optarg, &hold_on_other_key_presses); break;
+            case 'T': typed = true; break;
+            case 'j': workers = parse_number(optarg); break;
+            default: usage();
+            // clang-format on
+        }
+    }
+    if (optind == argc || workers < 1 || workers > MAX_WORKERS) {
+        usage();
+    }
+#ifndef COMBO_ENABLE
+    combo_terms.values[0] = keymap_settings.combo_term;
+    combo_terms.count     = 1;
+#endif
+    if (!has_own_combo_terms()) {
+        per_combo_terms.values[0] = 0;
+        per_combo_terms.count     = 1;
+    }
+
+    trace_count = argc - optind;
+    traces      = calloc(trace_count, sizeof(trace_t));
+    size_t presses = 0;
+    for (size_t i = 0; i < trace_count; i++) {
+        trace_t *trace = &traces[i];
+        trace->name    = argv[optind + i];
+        FILE *file     = fopen(trace->name, "r");
+        if (!file) {
+            fprintf(stderr, "sweep: %s: %s\n", trace->name, strerror(errno));
+            return 1;
+        }
+        read_trace(file, trace);
+        fclose(file);
+        if (trace->count == 0) {
+            fprintf(stderr, "sweep: %s: no key events\n", trace->name);
+            return 1;
+        }
+        for (size_t j = 0; j < trace->count; j++) {
+            presses += trace->events[j].pressed;
+        }
+        trace->expected = !typed && read_expected(trace);
+        if (!trace->expected) {
+            run_t run    = {0};
+            sim_settings = keymap_settings;
+            run_trace(trace, &run);
+            trace->intended = run.tokens;
+        }
+        if (typed) {
+            char name[64];
+            for (size_t j = 0; j < trace->intended.count; j++) {
+                token_name(trace->intended.tokens[j].code, name, sizeof(name));
+                printf("%s%s", j ? " " : "", name);
+            }
+            printf("\n");
+        }
+    }
+    if (typed) {
+        return 0;
+    }
+
+    size_t          count    = (size_t)tapping_terms.count * combo_terms.count * per_combo_terms.count * permissive_holds.count * hold_on_other_key_presses.count;
+    sim_settings_t *settings = calloc(count + 1, sizeof(sim_settings_t));
+    result_t       *results  = calloc(count + 1, sizeof(result_t));
+    size_t          index    = 0;
+    for (uint8_t t = 0; t < tapping_terms.count; t++) {
+        for (uint8_t c = 0; c < combo_terms.count; c++) {
+            for (uint8_t C = 0; C < per_combo_terms.count; C++) {
+                for (uint8_t p = 0; p < permissive_holds.count; p++) {
+                    for (uint8_t o = 0; o < hold_on_other_key_presses.count; o++) {
+                        sim_settings_t *setting          = &settings[index++];
+                        *setting                         = keymap_settings;
+                        setting->tapping_term            = tapping_terms.values[t];
+                        setting->quick_tap_term          = quick_tap_follows ? setting->tapping_term : keymap_settings.quick_tap_term;
+                        setting->combo_term              = combo_terms.values[c];
+                        setting->per_combo_term          = per_combo_terms.values[C];
+                        setting->permissive_hold         = (int8_t)permissive_holds.values[p];
+                        setting->hold_on_other_key_press = (int8_t)hold_on_other_key_presses.values[o];
+                    }
+                }
+            }
+        }
+    }
+    settings[count] = keymap_settings; // for comparison
+    if (workers > count + 1) {
+        workers = count + 1;
+    }
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    evaluate_all(settings, results, count + 1, workers);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double   seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+    result_t keymap  = results[count];
+    fprintf(stderr, "%zu settings x %zu trace(s) in %.1f s with %u worker(s)\n", count, trace_count, seconds, workers);
+
+    size_t expected = 0;
+    for (size_t i = 0; i < trace_count; i++) {
+        expected += traces[i].expected;
+    }
+    printf("traces: %zu with %zu presses, intended output: %zu from .expected files, %zu with the keymap's settings\n", trace_count, presses, expected, trace_count - expected);
+    printf("%-8s %7s %6s %9s %10s %10s %7s %8s %8s\n", "", "tapping", "combo", "per-combo", "permissive", "hold-other", "edits", "lag ms", "p90 ms");
+    print_result("keymap", &keymap);
+    qsort(results, count, sizeof(result_t), compare_results);
+    double best_lag = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0 || results[i].mean_lag < best_lag) {
+            print_result(i == 0 ? "best" : "", &results[i]);
+            best_lag = results[i].mean_lag;
+        }
+    }
+    if (keymap.edits <= results[0].edits && keymap.mean_lag <= results[0].mean_lag) {
+        printf("\nThe keymap's settings are as good as the best.\n");
+    } else {
+        print_config(&results[0], &keymap);
+    }
+    return 0;
+}
@@ -1 +1,94 @@
 #include "zilpzalp.h"
+
+// Key events arrive here before combos and tap-hold get to see (and possibly buffer) them:
+bool pre_process_record_kb(uint16_t keycode, keyrecord_t *record) {
+#ifdef TRACE_ENABLE
+    trace_record(keycode, record);
+#endif
+#ifdef KEYLOG_ENABLE
+    keylog_record(record);
+#endif
+#ifdef KEY_STATE_ENABLE
+    key_state_enter(keycode, record);
+#endif
+#ifdef RELEASE_HOLD_ENABLE
+    release_hold_record(record);
+#endif
+#ifdef LAYER_TAP_STREAK_ENABLE
+    layer_tap_streak_record(keycode, record);
+#endif
+#ifdef SPECULATIVE_HOLD_ENABLE
+    speculative_hold_record(keycode, record);
+#endif
+    return pre_process_record_user(keycode, record);
+}
+
+// Key events arrive here once tap-hold has decided about them:
+bool process_record_kb(uint16_t keycode, keyrecord_t *record) {
+#ifdef LATENCY_PROBE_ENABLE
+    if (!latency_probe_process(keycode, record)) {
+        return false;
+    }
+#endif
+#ifdef TRACE_ENABLE
+    if (!trace_resolve(keycode, record)) {
+        return false;
+    }
+#endif
+#ifdef KEYLOG_ENABLE
+    if (!keylog_process(keycode, record)) {
+        return false;
+    }
+#endif
+#ifdef SPECULATIVE_HOLD_ENABLE
+    speculative_hold_resolve(keycode, record);
+#endif
+    if (!process_record_user(keycode, record)) {
+        return false;
+    }
+#ifdef EDIT_ACTIONS_ENABLE
+    if (!edit_actions_process(keycode, record)) {
+        return false;
+    }
+#endif
+#ifdef OVERRIDE_TABLE_ENABLE
+    // After the keymap, like QMK's key overrides:
+    if (!override_table_process(keycode, record)) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+void matrix_scan_kb(void) {
+#ifdef LATENCY_PROBE_ENABLE
+    latency_probe_scan();
+#endif
+    matrix_scan_user();
+}
+
+void keyboard_post_init_kb(void) {
+#ifdef OVERRIDE_TABLE_ENABLE
+    override_table_init();
+#endif
+#ifdef MAGIC_KEY_ENABLE
+    magic_key_init();
+#endif
+    keyboard_post_init_user();
+}
+
+void housekeeping_task_kb(void) {
+#ifdef LATENCY_PROBE_ENABLE
+    latency_probe_task(); // before the tasks that send reports
+#endif
+#ifdef MACRO_QUEUE_ENABLE
+    macro_queue_task();
+#endif
+#ifdef TRACE_ENABLE
+    trace_task();
+#endif
+#ifdef KEYLOG_ENABLE
+    keylog_task();
+#endif
+    housekeeping_task_user();
+}
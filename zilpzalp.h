@@ -1,5 +1,58 @@
+#pragma once
+
 #include "quantum.h"
 
+#ifdef KEY_STATE_ENABLE
+#    include "features/key_state.h"
+#endif
+#ifdef RELEASE_HOLD_ENABLE
+#    include "features/release_hold.h"
+#endif
+#ifdef SPECULATIVE_HOLD_ENABLE
+#    include "features/speculative_hold.h"
+#endif
+#ifdef TRACE_ENABLE
+#    include "features/trace.h"
+#endif
+#ifdef KEYLOG_ENABLE
+#    include "features/keylog.h"
+#endif
+#ifdef LATENCY_PROBE_ENABLE
+#    include "features/latency_probe.h"
+#endif
+#ifdef LAYER_TAP_STREAK_ENABLE
+#    include "features/layer_tap_streak.h"
+#endif
+#ifdef TAP_DANCE_TABLE_ENABLE
+#    include "features/tap_dance_table.h"
+#endif
+#ifdef OVERRIDE_TABLE_ENABLE
+#    include "features/override_table.h"
+#endif
+#ifdef MACRO_QUEUE_ENABLE
+#    include "features/macro_queue.h"
+#endif
+#ifdef PACKED_STRING_ENABLE
+#    include "features/packed_string.h"
+#endif
+#ifdef EDIT_ACTIONS_ENABLE
+#    include "features/edit_actions.h"
+#endif
+#ifdef MAGIC_KEY_ENABLE
+#    include "features/magic_key.h"
+#endif
+
+// Keycodes handled by the keyboard-level features:
+enum keyboard_keycodes {
+    TRACE_DUMP = QK_KB_0, // see features/trace.h
+    EDIT_DELETE_WORD,     // see features/edit_actions.h
+    EDIT_DELETE_LINE,
+    EDIT_DUPLICATE_LINE,
+    EDIT_SELECT_WORD,
+    KEYLOG_DUMP,   // see features/keylog.h
+    LATENCY_PROBE, // see features/latency_probe.h
+};
+
 #define LAYOUT( \
               K01, K02, K03, K04,    K05, K06, K07, K08,      \
          K20, K11, K12, K13, K14,    K15, K16, K17, K18, K29, \